@@ -17,8 +17,137 @@
 #define	RANDOM__NUS__X_1__HEADER__FILE__
 
 #include	<stdint.h>
+#include	<stddef.h>
 #include	<limits.h>
+#include	<string.h>
+
+#if defined(ARDUINO)
 #include	<Arduino.h>
+#endif
+
+#if defined(__AVR__)
+#include	<avr/pgmspace.h>
+#endif
+
+#include	"RandomX1Engines.h"
+
+//
+// Constant tables that are only read byte by byte are kept in flash on AVR
+//
+#if defined(__AVR__)
+#define	RANDOMX1_PROGMEM				PROGMEM
+#define	RANDOMX1_READ_BYTE(address)		pgm_read_byte(address)
+#else
+#define	RANDOMX1_PROGMEM
+#define	RANDOMX1_READ_BYTE(address)		(*(const uint8_t *)(address))
+#endif
+
+//
+// Engine used to fill the bit pool, see RandomX1Engines.h.  The native
+// engine only exists on Arduino, host builds default to xorshift32.
+//
+#ifndef	RANDOMX1_ENGINE
+#if defined(ARDUINO)
+#define	RANDOMX1_ENGINE		RandomX1NativeEngine
+#else
+#define	RANDOMX1_ENGINE		RandomX1Xorshift32
+#endif
+#endif
+
+//
+// Bit pool layout
+//
+//		RANDOMX1_POOL_SHIFT		each pool word is shifted right as its bits
+//								are used (default)
+//		RANDOMX1_POOL_BYTES		the pool is a byte array read at a bit cursor,
+//								so bits are read as byte-aligned chunks and
+//								the pool is never shifted
+//		RANDOMX1_POOL_STAGED	each pool is a 64-bit staging register that
+//								is topped up after every request, so
+//								requests never span a refill and _get_bits()
+//								has no branches.  For 32 and 64-bit hosts,
+//								not AVR.  Faster than the shift layout only
+//								when request sizes vary unpredictably, and
+//								only with 32-bit engines
+//
+#define	RANDOMX1_POOL_SHIFT		0
+#define	RANDOMX1_POOL_BYTES		1
+#define	RANDOMX1_POOL_STAGED	2
+
+#ifndef	RANDOMX1_POOL_LAYOUT
+#define	RANDOMX1_POOL_LAYOUT	RANDOMX1_POOL_SHIFT
+#endif
+
+//
+// Bit pool depth, in engine words per pool.  When the buffered words are
+// used up they are refilled with a single call to the engine's fill(), which
+// trades RAM for fewer and cheaper refills.
+//
+// RAM used by RandomX1 on AVR in bytes, not counting the engine state
+// (native 0, xorshift32 4, xorshift16 2, xorshift8 1, JSF8 4, LFSR8 1) or
+// the vtable pointer:
+//
+//		Words	Shift 32-bit	Shift 16-bit	Shift 8-bit		Bytes layout
+//		1		11				7				5				15 (native 19)
+//		4		45				25				15				39 (native 55)
+//		8		77				41				23				71 (native 103)
+//		16		141				73				39				135 (native 199)
+//
+// With RANDOMX1_SINGLE_POOL the pool part of these is halved.  With
+// RANDOMX1_POOL_BYTES the refill also needs the words on the stack while
+// they're unpacked into the byte pool.
+//
+// At most 255 words.  RANDOMX1_POOL_BYTES refills at least 4 bytes per word
+// of depth in at most 255 engine words, so it allows 63 words with the
+// 8-bit engines and 127 with the 16-bit and native engines.
+//
+#ifndef	RANDOMX1_POOL_WORDS
+#define	RANDOMX1_POOL_WORDS		1
+#endif
+
+#if RANDOMX1_POOL_WORDS < 1
+#error "RandomX1: RANDOMX1_POOL_WORDS must be at least 1"
+#endif
+
+// Word indexes and refill counts are 8-bit
+#if RANDOMX1_POOL_WORDS > 255
+#error "RandomX1: RANDOMX1_POOL_WORDS must be at most 255"
+#endif
+
+#if RANDOMX1_POOL_LAYOUT == RANDOMX1_POOL_STAGED && RANDOMX1_POOL_WORDS != 1
+#error "RandomX1: RANDOMX1_POOL_STAGED does not support RANDOMX1_POOL_WORDS"
+#endif
+
+//
+// By default there are two pools and every request alternates between them.
+// Define RANDOMX1_SINGLE_POOL to use one pool whose bits are consumed
+// contiguously; this halves the pool RAM and removes the pool index from
+// every request.
+//
+#ifdef	RANDOMX1_SINGLE_POOL
+#define	RANDOMX1_POOL_COUNT		1
+#else
+#define	RANDOMX1_POOL_COUNT		2
+#endif
+
+//
+// RandomX1::RangeSampler scales draws with a 64-bit multiply instead of
+// using rejection, except on AVR where the multiply is too slow
+//
+#ifndef	RANDOMX1_RANGE_MULTIPLY
+#if defined(__AVR__)
+#define	RANDOMX1_RANGE_MULTIPLY		0
+#else
+#define	RANDOMX1_RANGE_MULTIPLY		1
+#endif
+#endif
+
+//
+// _randomx1_same_type<>, compile time type comparison (no <type_traits> on
+// AVR)
+//
+template<class A, class B> struct _randomx1_same_type { static const bool value = false; };
+template<class A> struct _randomx1_same_type<A, A> { static const bool value = true; };
 
 
 /*
@@ -33,26 +162,35 @@
  * average ranges of numbers, depending on the specific range of numbers
  * being requested.
  *
+ * The bits come from a small pool that is refilled from the generator engine
+ * selected with RANDOMX1_ENGINE (see RandomX1Engines.h).  The pool words have
+ * the same width as the engine words, so with the 8 and 16-bit engines small
+ * requests stay in 8 or 16-bit arithmetic.  RANDOMX1_POOL_LAYOUT selects how
+ * the pool is stored; the public interface is the same for every layout.
+ *
+ * The engine is a template parameter so that one program can hold
+ * generators over different engines; RandomX1 (below) is the generator over
+ * RANDOMX1_ENGINE.  The pool layout and depth macros apply to every
+ * RandomX1T<> and must be the same in every file of a program.
+ *
  */
-class RandomX1
+template<class Engine>
+class RandomX1T
 {
 public:
+	typedef Engine								engine_type;
+	typedef typename engine_type::word_type		word_type;
+
 	//
 	// Constructor, seed initialized to 0.  randomSeed() can be called at a
 	// later time to set (or re-set) random seed.
 	//
-	RandomX1(unsigned long seed = 0)
+	RandomX1T(unsigned long seed = 0)
 	{
-		m_ctrlIndex = 0;
-		m_bitCounts[0] = BITS_PER_NATIVE_RANDOM;
-		m_bitCounts[1] = BITS_PER_NATIVE_RANDOM;
-		m_bits[0] = ::random(LONG_MAX);
-		m_bits[1] = ::random(LONG_MAX);
-
-		::randomSeed(seed);
+		this->randomSeed(seed);
 	}
 
-	virtual ~RandomX1()
+	virtual ~RandomX1T()
 	{
 	}
 
@@ -60,12 +198,19 @@ public:
 	// randomSeed()
 	//
 	// Set a new seed.  This can be called at any time to modify the seed.
-	// This is just a wrapper around the standard ::randomSeed() function.
-	// With no argument.
+	// The engine is re-seeded and the pool is refilled, so the same seed
+	// always produces the same sequence.  With the native engine this seeds
+	// the C library random(), like the standard ::randomSeed() function.
 	//
 	void randomSeed(unsigned long seed)
 	{
-		::randomSeed(seed);
+		m_engine.seed(seed);
+
+#if RANDOMX1_POOL_COUNT > 1
+		m_ctrlIndex = 0;
+		this->_reset(1);
+#endif
+		this->_reset(0);
 	}
 
 	//
@@ -103,8 +248,7 @@ public:
 			bit_count = MAX_BITS_PER_RANDOM_REQUEST;
 		}
 
-		m_ctrlIndex ^= 0x01;
-		return this->_get_bits(bit_count) + offset;
+		return this->_next_bits(bit_count) + offset;
 	}
 
 	//
@@ -126,10 +270,11 @@ public:
 		long		diff, res;
 		uint8_t		req_bits;
 
+		// Largest value to return, before 'min_val' is added
 		diff = max_val - min_val - 1;
 
 		if(diff <= 0) {
-			return 0;
+			return min_val;
 		}
 
 		// Limit requested value range
@@ -140,29 +285,38 @@ public:
 		// Get the minimum number of bits needed
 		req_bits = this->_get_required_bits(diff);
 
+#if RANDOMX1_POOL_COUNT > 1
 		res = this->randomBits(req_bits);
 
 		// out of range
-		if(res >= diff) {
+		if(res > diff) {
 			// randomBits advanced the control index, try again
 			res = this->randomBits(req_bits);
 
-			if(res >= diff) {
+			if(res > diff) {
 				// bits have already been removed by randomBits, so it's safe
 				// to just peek and only remove the bits if they can be used
 				if(!this->_peek_bits(req_bits, diff, res)) {
-					if(res >= diff) {
-						// advance index and peek at the other bits
-						m_ctrlIndex ^= 0x01;
-
-						if(!this->_peek_bits(req_bits, diff, res)) {
-							// tried 2-4 times, give up and just use native interface
-							res = ::random(diff);
-						}
+					// advance index and peek at the other bits
+					m_ctrlIndex ^= 0x01;
+
+					if(!this->_peek_bits(req_bits, diff, res)) {
+						// tried 2-4 times, keep drawing until a value fits
+						do {
+							res = this->randomBits(req_bits);
+						} while(res > diff);
 					}
 				}
 			}
 		}
+#else
+		// Bits are used contiguously, so a rejected value just continues
+		// with the following bits of the same pool.  More than half of the
+		// values are in range, so this takes less than 2 tries on average.
+		do {
+			res = this->_get_bits(req_bits);
+		} while(res > diff);
+#endif
 
 		return (res + min_val);
 	}
@@ -175,13 +329,535 @@ public:
 		return this->random(0, max_val);
 	}
 
+	//
+	// randomBits8(), randomBits16()
+	//
+	// Same as randomBits() for at most 8 or 16 bits, but the whole path,
+	// including adding 'offset', is done in 8 or 16-bit arithmetic instead
+	// of long.  The offset wraps around within the type.  These take bits
+	// from the same pool as randomBits(); with the shift layout they return
+	// exactly what randomBits() would have.
+	//
+	// - When 'bit_count' == 0, 0 is always returned
+	// - 'bit_count' is limited to 8 or 16
+	//
+	inline uint8_t randomBits8(uint8_t bit_count, uint8_t offset = 0)
+	{
+		if(bit_count == 0) {
+			return 0;
+		}
+
+		if(bit_count > 8) {
+			bit_count = 8;
+		}
+
+		return this->_next_narrow_bits<uint8_t>(bit_count) + offset;
+	}
+
+	inline uint16_t randomBits16(uint8_t bit_count, uint16_t offset = 0)
+	{
+		if(bit_count == 0) {
+			return 0;
+		}
+
+		if(bit_count > 16) {
+			bit_count = 16;
+		}
+
+		return this->_next_narrow_bits<uint16_t>(bit_count) + offset;
+	}
+
+	//
+	// random8(), random16()
+	//
+	// Same as random() for unsigned 8 or 16-bit ranges, with the range,
+	// rejection test and 'min_val' kept in 8 or 16-bit arithmetic.
+	//
+	// Arguments:
+	//		min_val, minimum value to return, inclusive (optional)
+	//		max_val, maximum value to return, exclusive
+	//
+	inline uint8_t random8(uint8_t min_val, uint8_t max_val)
+	{
+		uint8_t		diff, res, req_bits;
+
+		if(max_val <= min_val) {
+			return min_val;
+		}
+
+		// Largest value to return, before 'min_val' is added
+		if((diff = max_val - min_val - 1) == 0) {
+			return min_val;
+		}
+
+		req_bits = _required_bits8(diff);
+
+		do {
+			res = this->_next_narrow_bits<uint8_t>(req_bits);
+		} while(res > diff);
+
+		return res + min_val;
+	}
+
+	inline uint8_t random8(uint8_t max_val)
+	{
+		return this->random8(0, max_val);
+	}
+
+	inline uint16_t random16(uint16_t min_val, uint16_t max_val)
+	{
+		uint16_t	diff, res;
+		uint8_t		req_bits;
+
+		if(max_val <= min_val) {
+			return min_val;
+		}
+
+		// Largest value to return, before 'min_val' is added
+		if((diff = max_val - min_val - 1) == 0) {
+			return min_val;
+		}
+
+		req_bits = _required_bits16(diff);
+
+		do {
+			res = this->_next_narrow_bits<uint16_t>(req_bits);
+		} while(res > diff);
+
+		return res + min_val;
+	}
+
+	inline uint16_t random16(uint16_t max_val)
+	{
+		return this->random16(0, max_val);
+	}
+
+	//
+	// RangeSampler
+	//
+	// Samples a range that stays the same for many calls, e.g.
+	//
+	//		RandomX1::RangeSampler	led(rng, numLeds);
+	//		...
+	//		strip[led.sample()] = color;
+	//
+	// The range, clamping and required bit count that random() works out on
+	// every call are computed once, so sample() is just the draw and the
+	// rejection test.  Results have the same distribution as random() and
+	// come from the same pool.  The RandomX1 must outlive the sampler.
+	//
+	// Where a 64-bit multiply is cheap (RANDOMX1_RANGE_MULTIPLY, default
+	// everywhere except AVR) sample() scales a full MAX_BITS_PER_RANDOM_REQUEST
+	// bit draw by the range instead (Lemire's multiply-shift).  A draw is
+	// only rejected when its low bits fall below a precomputed threshold,
+	// which for small ranges almost never happens, so there is no
+	// unpredictable rejection loop.
+	//
+	class RangeSampler
+	{
+	public:
+		RangeSampler(RandomX1T &rng, long min_val, long max_val)
+			: m_rng(rng)
+		{
+			this->set(min_val, max_val);
+		}
+
+		RangeSampler(RandomX1T &rng, long max_val)
+			: m_rng(rng)
+		{
+			this->set(0, max_val);
+		}
+
+		//
+		// set()
+		//
+		// Change the range, same arguments as random()
+		//
+		void set(long min_val, long max_val)
+		{
+			m_min = min_val;
+			m_diff = max_val - min_val - 1;
+
+			if(m_diff <= 0) {
+				// Single value, sample() always returns 'min_val'
+				m_diff = 0;
+				m_bitCount = 0;
+				return;
+			}
+
+			if(m_diff > MAX_VALUE_PER_RANDOM_REQUEST) {
+				m_diff = MAX_VALUE_PER_RANDOM_REQUEST;
+			}
+
+			m_bitCount = m_rng._get_required_bits(m_diff);
+
+#if RANDOMX1_RANGE_MULTIPLY
+			// Draws whose low bits are below (2^bits mod range) are rejected
+			m_range = m_diff + 1;
+			m_threshold = (uint32_t)((MAX_VALUE_PER_RANDOM_REQUEST + 1) % m_range);
+#endif
+		}
+
+		//
+		// sample()
+		//
+		// Returns a random number between 'min_val' (inclusive) and 'max_val'
+		// (exclusive) of the current range
+		//
+		inline long sample()
+		{
+			if(m_bitCount == 0) {
+				return m_min;
+			}
+
+#if RANDOMX1_RANGE_MULTIPLY
+			uint64_t	scaled;
+
+			do {
+				scaled = (uint64_t)m_rng._next_bits(MAX_BITS_PER_RANDOM_REQUEST) * m_range;
+			} while((uint32_t)(scaled & MAX_VALUE_PER_RANDOM_REQUEST) < m_threshold);
+
+			return (long)(scaled >> MAX_BITS_PER_RANDOM_REQUEST) + m_min;
+#else
+			long	res;
+
+			do {
+				res = m_rng._next_bits(m_bitCount);
+			} while(res > m_diff);
+
+			return res + m_min;
+#endif
+		}
+
+	private:
+		RandomX1T		&m_rng;
+		long			m_min;
+		// Largest value to draw, before 'm_min' is added
+		long			m_diff;
+		uint8_t			m_bitCount;
+#if RANDOMX1_RANGE_MULTIPLY
+		uint32_t		m_range;
+		uint32_t		m_threshold;
+#endif
+	};
+
+	//
+	// UniformRandomBitGenerator interface
+	//
+	// Lets RandomX1 be passed to std::shuffle(), std::uniform_int_distribution
+	// and other host code templated on a standard random bit generator.  Each
+	// call returns a full engine word; the bit pool used by randomBits() and
+	// random() is not touched, so no masking or shifting is done.
+	//
+	// On a host with xorshift32, std::uniform_int_distribution and
+	// std::normal_distribution run about 2x faster over RandomX1 than over
+	// std::mt19937 and a little faster than over std::minstd_rand.  With
+	// the 8 and 16-bit engines each call takes a narrow word, so the
+	// distributions need more calls; JSF8 and xorshift8 are slower than
+	// std::mt19937 there.
+	//
+	// NOTE: min and max are parenthesized so the Arduino min()/max() macros
+	//       don't expand them.
+	//
+	typedef word_type	result_type;
+
+	static constexpr result_type (min)()
+	{
+		return engine_type::MIN_WORD;
+	}
+
+	static constexpr result_type (max)()
+	{
+		return engine_type::MAX_WORD;
+	}
+
+	inline result_type operator()()
+	{
+		return m_engine.next();
+	}
+
+	//
+	// randomBytes()
+	//
+	// Fills 'buffer' with 'count' random bytes.  Like operator(), this uses
+	// whole engine words and does not touch the bit pool; the engine is
+	// stepped a block of words at a time with fill().  Only whole bytes of
+	// each word are used, 3 per word with the native engine.
+	//
+	void randomBytes(uint8_t *buffer, size_t count)
+	{
+		word_type	words[WORDS_PER_BYTES_BLOCK];
+		word_type	word;
+		uint8_t		word_count;
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+		// Words that are all random bytes are already in the byte order the
+		// loop below produces, copy whole blocks
+		if(BYTES_PER_ENGINE_WORD == sizeof(word_type)) {
+			while(count >= sizeof(words)) {
+				m_engine.fill(words, WORDS_PER_BYTES_BLOCK);
+				memcpy(buffer, words, sizeof(words));
+				buffer += sizeof(words);
+				count -= sizeof(words);
+			}
+		}
+#endif
+
+		while(count > 0) {
+			word_count = (count >= WORDS_PER_BYTES_BLOCK * BYTES_PER_ENGINE_WORD) ?
+					WORDS_PER_BYTES_BLOCK :
+					(uint8_t)((count + BYTES_PER_ENGINE_WORD - 1) / BYTES_PER_ENGINE_WORD);
+
+			m_engine.fill(words, word_count);
+
+			for(uint8_t i = 0; i < word_count; i++) {
+				word = words[i];
+
+				for(uint8_t j = 0; j < BYTES_PER_ENGINE_WORD && count > 0; j++, count--) {
+					*buffer++ = (uint8_t)word;
+					word = (word_type)((uint32_t)word >> 8);
+				}
+			}
+		}
+	}
+
+	//
+	// bernoulliMask32()
+	//
+	// Returns 32 independent random bits, each set with probability
+	// 'p' / 2^'resolution_bits', e.g. one bit per LED for a sparkle effect:
+	//
+	//		uint32_t	fire = rng.bernoulliMask32(26);	// ~10% (26/256)
+	//
+	// Starting from an empty mask, whole random words are ORed in for the
+	// 1 bits of 'p' and ANDed in for the 0 bits, lowest bit first.  That
+	// takes 'resolution_bits' words less the trailing zero bits of 'p',
+	// instead of 32 range reductions.  Like operator(), this uses engine
+	// words and does not touch the bit pool.
+	//
+	// - 'resolution_bits' is limited to 16
+	// - When 'p' >= 2^'resolution_bits' all bits are set
+	//
+	inline uint32_t bernoulliMask32(uint16_t p, uint8_t resolution_bits = 8)
+	{
+		uint32_t	mask = 0;
+
+		if(resolution_bits > 16) {
+			resolution_bits = 16;
+		}
+
+		if(p >= ((uint32_t)1 << resolution_bits)) {
+			return 0xffffffff;
+		}
+
+		if(p == 0) {
+			return 0;
+		}
+
+		// ANDing into an empty mask leaves it empty
+		while((p & 0x01) == 0) {
+			p >>= 1;
+			resolution_bits--;
+		}
+
+		// After each word, every bit is set with probability
+		// (bit of 'p' + previous probability) / 2
+		for(; resolution_bits > 0; resolution_bits--, p >>= 1) {
+			if(p & 0x01) {
+				mask |= this->_next_word32();
+			}
+			else {
+				mask &= this->_next_word32();
+			}
+		}
+
+		return mask;
+	}
+
+	//
+	// gaussianApprox16()
+	//
+	// Returns an approximately normal random number with the given 'mean'
+	// and 'stddev', using only integer operations.
+	//
+	// The bell curve is the popcount of 64 random bits (binomial, mean 32,
+	// standard deviation 4), counted with a byte-wise table in flash, plus
+	// 4 bits of centred uniform dither that fill in the steps between
+	// popcounts.  The standard deviation comes out 0.26% above 'stddev'.
+	// The result is limited to about 8.1 standard deviations, and the far
+	// tails are thinner than a normal distribution:
+	//
+	//		|z| >=		1			2			3			4			5
+	//		this		3.21e-1		4.64e-2		2.63e-3		5.08e-5		2.79e-7
+	//		normal		3.17e-1		4.55e-2		2.70e-3		6.33e-5		5.73e-7
+	//
+	// Good for sensor noise and jitter, not for simulations that depend on
+	// the tails.  Each call takes two engine words and 4 pool bits, does 8
+	// table lookups and one 16x16-bit multiply.  Results outside the int16_t
+	// range are clamped.
+	//
+	// NOTE: The popcounts of consecutive words from linear engines
+	//       (xorshift, LFSR) are correlated, which makes the tails heavier
+	//       (2x at 4 standard deviations for xorshift32).  Off AVR each word
+	//       is multiplied by an odd constant first, which removes this.  On
+	//       AVR use the native or JSF8 engine; the 8-bit xorshift and LFSR
+	//       periods are also far too short for this.
+	//
+	inline int16_t gaussianApprox16(int16_t mean, uint16_t stddev)
+	{
+		uint32_t	word;
+		uint8_t		count = 0;
+		int16_t		z;
+		int32_t		res;
+
+		for(uint8_t i = 0; i < 2; i++) {
+			word = this->_next_word32();
+#if !defined(__AVR__)
+			word *= 0x9e3779b9;
+#endif
+			count += _popcount8((uint8_t)word) + _popcount8((uint8_t)(word >> 8)) +
+					_popcount8((uint8_t)(word >> 16)) + _popcount8((uint8_t)(word >> 24));
+		}
+
+		// Standard deviation of 128 units, dither is -15 to 15 in steps of 2
+		z = (int16_t)((count - 32) * 32) + (int16_t)(this->randomBits8(4) * 2) - 15;
+
+		// Round to nearest
+		res = (int32_t)mean + (((int32_t)z * stddev + 64) >> 7);
+
+		if(res > INT16_MAX) {
+			return INT16_MAX;
+		}
+		else if(res < INT16_MIN) {
+			return INT16_MIN;
+		}
+
+		return (int16_t)res;
+	}
+
+	//
+	// stochasticRoundShift()
+	//
+	// Returns 'value' >> 'shift', rounded up with probability equal to the
+	// dropped fraction, so on average the result is exactly
+	// 'value' / 2^'shift' and fixed-point filters don't build up the bias of
+	// truncation.  Exactly 'shift' bits are taken from the pool and added
+	// below the cut; the carry out of them is the round up.
+	//
+	// - When 'shift' == 0, 'value' is returned unchanged
+	// - 'shift' is limited to 31; above MAX_BITS_PER_RANDOM_REQUEST only the
+	//		top MAX_BITS_PER_RANDOM_REQUEST dropped bits take part in rounding
+	//
+	inline int32_t stochasticRoundShift(int32_t value, uint8_t shift)
+	{
+		if(shift == 0) {
+			return value;
+		}
+
+		if(shift > 31) {
+			shift = 31;
+		}
+
+		return this->_stochastic_round_shift(value, shift);
+	}
+
+	//
+	// stochasticRoundShift(), block version
+	//
+	// Same for 'count' values from 'input' to 'output', which may be the
+	// same buffer
+	//
+	void stochasticRoundShift(const int32_t *input, int32_t *output, size_t count, uint8_t shift)
+	{
+		if(shift > 31) {
+			shift = 31;
+		}
+
+		if(shift == 0) {
+			memmove(output, input, count * sizeof(int32_t));
+			return;
+		}
+
+		for(size_t i = 0; i < count; i++) {
+			output[i] = this->_stochastic_round_shift(input[i], shift);
+		}
+	}
+
 private:
 	//
-	// _get_required_bits()
+	// _stochastic_round_shift()
 	//
-	// Returns the minimum number of bits needed to represent 'num'
+	// 'shift' must be 1 to 31
 	//
-	inline uint8_t _get_required_bits(long num)
+	inline int32_t _stochastic_round_shift(int32_t value, uint8_t shift)
+	{
+		uint32_t	fraction = (uint32_t)value & (((uint32_t)1 << shift) - 1);
+		uint32_t	dither;
+
+		if(shift <= MAX_BITS_PER_RANDOM_REQUEST) {
+			dither = (uint32_t)this->_next_bits(shift);
+		}
+		else {
+			dither = (uint32_t)this->_next_bits(MAX_BITS_PER_RANDOM_REQUEST) << (shift - MAX_BITS_PER_RANDOM_REQUEST);
+		}
+
+		// Kept apart from 'value' so the sum can't overflow
+		return (value >> shift) + (int32_t)((fraction + dither) >> shift);
+	}
+
+private:
+	//
+	// _popcount8()
+	//
+	// Returns the number of set bits in 'num'
+	//
+	static inline uint8_t _popcount8(uint8_t num)
+	{
+		static const uint8_t POPCOUNT[256] RANDOMX1_PROGMEM = {
+			0x00, 0x01, 0x01, 0x02, 0x01, 0x02, 0x02, 0x03,
+			0x01, 0x02, 0x02, 0x03, 0x02, 0x03, 0x03, 0x04,
+			0x01, 0x02, 0x02, 0x03, 0x02, 0x03, 0x03, 0x04,
+			0x02, 0x03, 0x03, 0x04, 0x03, 0x04, 0x04, 0x05,
+			0x01, 0x02, 0x02, 0x03, 0x02, 0x03, 0x03, 0x04,
+			0x02, 0x03, 0x03, 0x04, 0x03, 0x04, 0x04, 0x05,
+			0x02, 0x03, 0x03, 0x04, 0x03, 0x04, 0x04, 0x05,
+			0x03, 0x04, 0x04, 0x05, 0x04, 0x05, 0x05, 0x06,
+			0x01, 0x02, 0x02, 0x03, 0x02, 0x03, 0x03, 0x04,
+			0x02, 0x03, 0x03, 0x04, 0x03, 0x04, 0x04, 0x05,
+			0x02, 0x03, 0x03, 0x04, 0x03, 0x04, 0x04, 0x05,
+			0x03, 0x04, 0x04, 0x05, 0x04, 0x05, 0x05, 0x06,
+			0x02, 0x03, 0x03, 0x04, 0x03, 0x04, 0x04, 0x05,
+			0x03, 0x04, 0x04, 0x05, 0x04, 0x05, 0x05, 0x06,
+			0x03, 0x04, 0x04, 0x05, 0x04, 0x05, 0x05, 0x06,
+			0x04, 0x05, 0x05, 0x06, 0x05, 0x06, 0x06, 0x07,
+			0x01, 0x02, 0x02, 0x03, 0x02, 0x03, 0x03, 0x04,
+			0x02, 0x03, 0x03, 0x04, 0x03, 0x04, 0x04, 0x05,
+			0x02, 0x03, 0x03, 0x04, 0x03, 0x04, 0x04, 0x05,
+			0x03, 0x04, 0x04, 0x05, 0x04, 0x05, 0x05, 0x06,
+			0x02, 0x03, 0x03, 0x04, 0x03, 0x04, 0x04, 0x05,
+			0x03, 0x04, 0x04, 0x05, 0x04, 0x05, 0x05, 0x06,
+			0x03, 0x04, 0x04, 0x05, 0x04, 0x05, 0x05, 0x06,
+			0x04, 0x05, 0x05, 0x06, 0x05, 0x06, 0x06, 0x07,
+			0x02, 0x03, 0x03, 0x04, 0x03, 0x04, 0x04, 0x05,
+			0x03, 0x04, 0x04, 0x05, 0x04, 0x05, 0x05, 0x06,
+			0x03, 0x04, 0x04, 0x05, 0x04, 0x05, 0x05, 0x06,
+			0x04, 0x05, 0x05, 0x06, 0x05, 0x06, 0x06, 0x07,
+			0x03, 0x04, 0x04, 0x05, 0x04, 0x05, 0x05, 0x06,
+			0x04, 0x05, 0x05, 0x06, 0x05, 0x06, 0x06, 0x07,
+			0x04, 0x05, 0x05, 0x06, 0x05, 0x06, 0x06, 0x07,
+			0x05, 0x06, 0x06, 0x07, 0x06, 0x07, 0x07, 0x08
+		};
+
+		return RANDOMX1_READ_BYTE(&POPCOUNT[num]);
+	}
+
+	//
+	// _required_bits8()
+	//
+	// Returns the minimum number of bits needed to represent 'num', 8-bit
+	// values only
+	//
+	static inline uint8_t _required_bits8(uint8_t num)
 	{
 		// Required number of bits needed for values 1 --> 255 (log2(n))
 		static const uint8_t REQUIRED_BITS[256] = {
@@ -219,40 +895,152 @@ private:
 			0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08
 		};
 
+		return REQUIRED_BITS[num];
+	}
+
+	//
+	// _required_bits16()
+	//
+	// Same as _required_bits8(), for 16-bit values
+	//
+	static inline uint8_t _required_bits16(uint16_t num)
+	{
+		uint8_t		high = (uint8_t)(num >> 8);
+
+		return (high != 0) ? 8 + _required_bits8(high) : _required_bits8((uint8_t)num);
+	}
+
+	//
+	// _get_required_bits()
+	//
+	// Returns the minimum number of bits needed to represent 'num'
+	//
+	inline uint8_t _get_required_bits(long num)
+	{
 		uint32_t	temp;
 		uint8_t		ret;
 
 		// If the result after shifting off 8 bits is zero, this number can
 		// be represented by 8 bits...
 		if((temp = (num >> 8)) == 0) {
-			ret = REQUIRED_BITS[num];
+			ret = _required_bits8(num);
 		}
 		// Need more than 8 bits, shift off another 8 bits and check if we've
 		// found the required bits; if not, more bits are needed (more than 16),
 		// so keep going.
 		else if((num = (temp >> 8)) == 0) {
-			ret = 8 + REQUIRED_BITS[temp];
+			ret = 8 + _required_bits8(temp);
 		}
 		// 17 --> 24 bits...
 		else if((temp = (num >> 8)) == 0) {
-			ret = 16 + REQUIRED_BITS[num];
+			ret = 16 + _required_bits8(num);
 		}
 		// 25 --> 32 bits...
 		else {
-			ret = 24 + REQUIRED_BITS[temp];
+			ret = 24 + _required_bits8(temp);
 		}
 
 		return ret;
 	}
 
+	//
+	// _next_bits()
+	//
+	// Advance to the next pool and take 'bit_count' bits, 'bit_count' must
+	// be 1 to MAX_BITS_PER_RANDOM_REQUEST
+	//
+	inline long _next_bits(uint8_t bit_count)
+	{
+#if RANDOMX1_POOL_COUNT > 1
+		m_ctrlIndex ^= 0x01;
+#endif
+		return this->_get_bits(bit_count);
+	}
+
+	//
+	// _next_word32()
+	//
+	// Returns 32 random bits straight from the engine, combining words when
+	// they are narrower than 32 bits
+	//
+	inline uint32_t _next_word32()
+	{
+		uint32_t	word = 0;
+
+		if(BITS_PER_ENGINE_WORD >= 32) {
+			return m_engine.next();
+		}
+
+		for(uint8_t i = 0; i < 4; i += BYTES_PER_ENGINE_WORD) {
+			// Shift is only reached for words narrower than 32 bits
+			word = (word << ((BITS_PER_ENGINE_WORD < 32) ? BYTES_PER_ENGINE_WORD * 8 : 0)) ^
+					(uint32_t)m_engine.next();
+		}
+
+		return word;
+	}
+
+	//
+	// _next_narrow_bits()
+	//
+	// Advance to the next pool (like randomBits()) and take 'bit_count' bits
+	// as a T, for the 8 and 16-bit API
+	//
+	template<class T> inline T _next_narrow_bits(uint8_t bit_count)
+	{
+#if RANDOMX1_POOL_COUNT > 1
+		m_ctrlIndex ^= 0x01;
+#endif
+		return this->_get_narrow_bits<T>(bit_count);
+	}
+
+#if RANDOMX1_POOL_LAYOUT == RANDOMX1_POOL_SHIFT
+	//
+	// _reset()
+	//
+	// Drop any buffered words for 'index' and refill the pool
+	//
+	inline void _reset(uint8_t index)
+	{
+#if RANDOMX1_POOL_WORDS > 1
+		m_wordIndexes[index] = RANDOMX1_POOL_WORDS;
+#endif
+		this->_refill(index);
+	}
+
+	//
+	// _refill()
+	//
+	// Replace the pool word for 'index' with a new engine word.  With a
+	// deeper pool the word comes from the buffer, which is refilled by one
+	// engine call when it's drained.
+	//
+	inline void _refill(uint8_t index)
+	{
+#if RANDOMX1_POOL_WORDS > 1
+		if(m_wordIndexes[index] == RANDOMX1_POOL_WORDS) {
+			m_engine.fill(m_words[index], RANDOMX1_POOL_WORDS);
+			m_wordIndexes[index] = 0;
+		}
+
+		m_bits[index] = m_words[index][m_wordIndexes[index]++];
+#else
+		m_bits[index] = m_engine.next();
+#endif
+		m_bitCounts[index] = BITS_PER_ENGINE_WORD;
+	}
+
 	//
 	// _peek_bits()
 	//
+	// Takes 'bit_count' bits into 'res' and returns true only if they are
+	// available without a refill and their value is at most 'num'.
+	//
 	inline bool _peek_bits(uint8_t bit_count, long num, long &res)
 	{
 		// Only actually do peek if there's enough bits
 		if(m_bitCounts[m_ctrlIndex] >= bit_count) {
-			if((m_bits[m_ctrlIndex] & this->_get_mask(bit_count)) < num) {
+			if((word_type)(m_bits[m_ctrlIndex] & this->_get_mask(bit_count)) <= num) {
 				// can satisfy requenst, so get the bits and return true
 				res = this->_get_bits(bit_count);
 				return true;
@@ -267,28 +1055,368 @@ private:
 	//
 	inline long _get_bits(uint8_t bit_count)
 	{
-		long	ret = 0;
+		long		ret = 0;
+		word_type	bits;
 
-		// Check if bit_count needs more bits than currently available
-		if(bit_count > m_bitCounts[m_ctrlIndex]) {
+		// Check if bit_count needs more bits than currently available.  With
+		// 8 or 16-bit engine words a request can span several words.
+		while(bit_count > m_bitCounts[m_ctrlIndex]) {
 			// Take the available bits; used as high-order bits. 'bit_count' is
 			// updated to the remaining number of bits needed.
 			bit_count -= m_bitCounts[m_ctrlIndex];
-			ret = (m_bits[m_ctrlIndex] << bit_count);
+			ret |= (long)this->_shift_left(m_bits[m_ctrlIndex], bit_count);
 
 			// Generate new bits
-			m_bits[m_ctrlIndex] = ::random(LONG_MAX);
-			m_bitCounts[m_ctrlIndex] = BITS_PER_NATIVE_RANDOM;
+			this->_refill(m_ctrlIndex);
 		}
 
-		ret |= (m_bits[m_ctrlIndex] & this->_get_mask(bit_count));
+		// Done in the width of the pool word
+		bits = (m_bits[m_ctrlIndex] & (word_type)this->_get_mask(bit_count));
 
 		// Get rid of bits that were just used
 		m_bitCounts[m_ctrlIndex] -= bit_count;
-		m_bits[m_ctrlIndex] >>= bit_count;
+		m_bits[m_ctrlIndex] = this->_shift_right(m_bits[m_ctrlIndex], bit_count);
+		return ret | bits;
+	}
+
+	//
+	// _get_narrow_bits()
+	//
+	// _get_bits() for the 8 and 16-bit API, 'bit_count' is at most the width
+	// of T.  The bits are combined in a T, so nothing is widened to long.
+	//
+	template<class T> inline T _get_narrow_bits(uint8_t bit_count)
+	{
+		T	ret = 0;
+
+		while(bit_count > m_bitCounts[m_ctrlIndex]) {
+			bit_count -= m_bitCounts[m_ctrlIndex];
+			ret |= (T)((T)m_bits[m_ctrlIndex] << bit_count);
+
+			this->_refill(m_ctrlIndex);
+		}
+
+		ret |= (T)m_bits[m_ctrlIndex] & (T)this->_get_mask(bit_count);
+
+		m_bitCounts[m_ctrlIndex] -= bit_count;
+		m_bits[m_ctrlIndex] = this->_shift_right(m_bits[m_ctrlIndex], bit_count);
 		return ret;
 	}
 
+#elif RANDOMX1_POOL_LAYOUT == RANDOMX1_POOL_BYTES
+	//
+	// _reset()
+	//
+	inline void _reset(uint8_t index)
+	{
+		this->_refill(index);
+	}
+
+	//
+	// _refill()
+	//
+	// Fill the byte pool for 'index' from the engine, in one engine call,
+	// and reset its cursor.  Only whole bytes of each engine word are used,
+	// so the native engine contributes 3 bytes per 31-bit word.
+	//
+	inline void _refill(uint8_t index)
+	{
+		uint8_t		*bytes = m_bytes[index];
+		word_type	words[WORDS_PER_REFILL];
+		word_type	word;
+
+		m_engine.fill(words, WORDS_PER_REFILL);
+
+		for(uint8_t i = 0; i < WORDS_PER_REFILL; i++) {
+			word = words[i];
+
+			for(uint8_t j = 0; j < BYTES_PER_ENGINE_WORD; j++) {
+				*bytes++ = (uint8_t)word;
+				word = (word_type)((uint32_t)word >> 8);
+			}
+		}
+
+		m_bitCursors[index] = 0;
+	}
+
+	//
+	// _read_bits()
+	//
+	// Returns 'bit_count' bits at the current cursor without using them.
+	// Only the bytes the request touches are read, so requests that fall
+	// within one or two bytes are done in 8 or 16-bit arithmetic and the
+	// only shift is by the 0-7 bit offset within the first byte.
+	//
+	inline uint32_t _read_bits(uint8_t bit_count)
+	{
+		const uint8_t	*bytes = &m_bytes[m_ctrlIndex][m_bitCursors[m_ctrlIndex] >> 3];
+		uint8_t			offset = m_bitCursors[m_ctrlIndex] & 0x07;
+		uint8_t			end = offset + bit_count;
+
+		if(end <= 8) {
+			return (uint8_t)(bytes[0] >> offset) & (uint8_t)this->_get_mask(bit_count);
+		}
+		else if(end <= 16) {
+			return this->_shift_right((uint16_t)(bytes[0] | ((uint16_t)bytes[1] << 8)), offset) &
+					(uint16_t)this->_get_mask(bit_count);
+		}
+
+		// Reads one byte past the end of the pool at most, m_bytes is padded
+		return this->_shift_right((uint32_t)bytes[0] |
+				((uint32_t)bytes[1] << 8) |
+				((uint32_t)bytes[2] << 16) |
+				((uint32_t)bytes[3] << 24), offset) & this->_get_mask(bit_count);
+	}
+
+	//
+	// _peek_bits()
+	//
+	// Same as the shift layout version
+	//
+	inline bool _peek_bits(uint8_t bit_count, long num, long &res)
+	{
+		uint32_t	bits;
+
+		// Only actually do peek if there's enough bits
+		if((uint16_t)(POOL_BITS - m_bitCursors[m_ctrlIndex]) >= bit_count) {
+			if((long)(bits = this->_read_bits(bit_count)) <= num) {
+				// can satisfy request, so use the bits and return true
+				m_bitCursors[m_ctrlIndex] += bit_count;
+				res = bits;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	//
+	// _get_bits()
+	//
+	inline long _get_bits(uint8_t bit_count)
+	{
+		long		ret = 0;
+		uint16_t	avail = POOL_BITS - m_bitCursors[m_ctrlIndex];
+
+		// Check if bit_count needs more bits than remain in the pool
+		if(bit_count > avail) {
+			// Take the remaining bits; used as high-order bits. 'bit_count'
+			// is updated to the remaining number of bits needed.
+			bit_count -= avail;
+			ret = this->_shift_left(this->_read_bits(avail), bit_count);
+
+			// Generate new bits
+			this->_refill(m_ctrlIndex);
+		}
+
+		ret |= this->_read_bits(bit_count);
+
+		// Move past bits that were just used
+		m_bitCursors[m_ctrlIndex] += bit_count;
+		return ret;
+	}
+#elif RANDOMX1_POOL_LAYOUT == RANDOMX1_POOL_STAGED
+	//
+	// _reset()
+	//
+	inline void _reset(uint8_t index)
+	{
+		m_stages[index] = 0;
+		m_stageCounts[index] = 0;
+		this->_refill(index);
+	}
+
+	//
+	// _refill()
+	//
+	// Top up the staging register for 'index' so it holds at least
+	// MAX_BITS_PER_RANDOM_REQUEST bits.  The engine is stepped
+	// REFILLS_PER_REQUEST times on every request and each word is shifted
+	// in above the bits held; the bits that don't fit the register are
+	// dropped and the count is limited to 64 with masks, so there is no
+	// branch on the request sizes.
+	//
+	inline void _refill(uint8_t index)
+	{
+		uint64_t	word;
+		uint8_t		count;
+
+		for(uint8_t i = 0; i < REFILLS_PER_REQUEST; i++) {
+			count = m_stageCounts[index];
+
+			// A full register takes nothing, the shift is kept below 64
+			word = (uint64_t)m_engine.next() & (0 - (uint64_t)(count < 64));
+			m_stages[index] |= word << (count & 63);
+
+			// min(count + bits, 64)
+			count += BITS_PER_ENGINE_WORD;
+			m_stageCounts[index] = count - ((count - 64) & (uint8_t)(0 - (count > 64)));
+		}
+	}
+
+	//
+	// _peek_bits()
+	//
+	// Same as the shift layout version, the staging register always has
+	// enough bits.
+	//
+	inline bool _peek_bits(uint8_t bit_count, long num, long &res)
+	{
+		if((long)(m_stages[m_ctrlIndex] & (uint32_t)this->_get_mask(bit_count)) <= num) {
+			res = this->_get_bits(bit_count);
+			return true;
+		}
+
+		return false;
+	}
+
+	//
+	// _get_bits()
+	//
+	// The staging register always holds at least 'bit_count' bits, so the
+	// bits are taken with a fixed sequence and the register is topped up
+	// for the next request.
+	//
+	inline long _get_bits(uint8_t bit_count)
+	{
+		long	ret;
+
+		ret = (long)(m_stages[m_ctrlIndex] & (uint32_t)this->_get_mask(bit_count));
+
+		// Get rid of bits that were just used
+		m_stages[m_ctrlIndex] >>= bit_count;
+		m_stageCounts[m_ctrlIndex] -= bit_count;
+
+		this->_refill(m_ctrlIndex);
+		return ret;
+	}
+#else
+#error "RandomX1: unknown RANDOMX1_POOL_LAYOUT"
+#endif
+
+#if RANDOMX1_POOL_LAYOUT != RANDOMX1_POOL_SHIFT
+	//
+	// _get_narrow_bits()
+	//
+	// The byte and staged layouts already read small requests in narrow
+	// arithmetic, the result is just truncated
+	//
+	template<class T> inline T _get_narrow_bits(uint8_t bit_count)
+	{
+		return (T)this->_get_bits(bit_count);
+	}
+#endif
+
+	//
+	// _shift_right()
+	//
+	// Returns 'bits >> count', 'count' can be 0 to 31.
+	//
+	// avr-gcc compiles a 32-bit shift by a variable count into a loop that
+	// shifts all four bytes one bit per pass (up to 20 passes for a default
+	// request).  On AVR this is replaced by assembly that first moves whole
+	// bytes (count & 0x18) and only loops for the remaining 0-7 bits, which
+	// bounds the loop to 7 passes.  Define RANDOMX1_NO_ASM to use the plain
+	// C++ version.
+	//
+	static inline uint32_t _shift_right(uint32_t bits, uint8_t count)
+	{
+#if defined(__AVR__) && !defined(RANDOMX1_NO_ASM)
+		asm(
+			"sbrs	%[count], 4"		"\n\t"
+			"rjmp	1f"					"\n\t"
+			"mov	%A[bits], %C[bits]"	"\n\t"
+			"mov	%B[bits], %D[bits]"	"\n\t"
+			"clr	%C[bits]"			"\n\t"
+			"clr	%D[bits]"			"\n\t"
+		"1:"							"\n\t"
+			"sbrs	%[count], 3"		"\n\t"
+			"rjmp	2f"					"\n\t"
+			"mov	%A[bits], %B[bits]"	"\n\t"
+			"mov	%B[bits], %C[bits]"	"\n\t"
+			"mov	%C[bits], %D[bits]"	"\n\t"
+			"clr	%D[bits]"			"\n\t"
+		"2:"							"\n\t"
+			"andi	%[count], 0x07"		"\n\t"
+			"breq	4f"					"\n\t"
+		"3:"							"\n\t"
+			"lsr	%D[bits]"			"\n\t"
+			"ror	%C[bits]"			"\n\t"
+			"ror	%B[bits]"			"\n\t"
+			"ror	%A[bits]"			"\n\t"
+			"dec	%[count]"			"\n\t"
+			"brne	3b"					"\n\t"
+		"4:"							"\n\t"
+			: [bits] "+r" (bits), [count] "+d" (count)
+		);
+
+		return bits;
+#else
+		return bits >> count;
+#endif
+	}
+
+	//
+	// 16-bit pool words, 'count' can be 0 to 16.  A shift by 16 would be
+	// undefined on AVR, where the word is promoted to a 16-bit int.
+	//
+	static inline uint16_t _shift_right(uint16_t bits, uint8_t count)
+	{
+		return (count < 16) ? (uint16_t)(bits >> count) : 0;
+	}
+
+	//
+	// 8-bit pool words, 'count' can be 0 to 8
+	//
+	static inline uint8_t _shift_right(uint8_t bits, uint8_t count)
+	{
+		return (uint8_t)(bits >> count);
+	}
+
+	//
+	// _shift_left()
+	//
+	// Returns 'bits << count', 'count' can be 0 to 31.  Used to place the
+	// high-order bits of a request that spans pool words.  Same approach as
+	// _shift_right() on AVR.
+	//
+	static inline uint32_t _shift_left(uint32_t bits, uint8_t count)
+	{
+#if defined(__AVR__) && !defined(RANDOMX1_NO_ASM)
+		asm(
+			"sbrs	%[count], 4"		"\n\t"
+			"rjmp	1f"					"\n\t"
+			"mov	%D[bits], %B[bits]"	"\n\t"
+			"mov	%C[bits], %A[bits]"	"\n\t"
+			"clr	%B[bits]"			"\n\t"
+			"clr	%A[bits]"			"\n\t"
+		"1:"							"\n\t"
+			"sbrs	%[count], 3"		"\n\t"
+			"rjmp	2f"					"\n\t"
+			"mov	%D[bits], %C[bits]"	"\n\t"
+			"mov	%C[bits], %B[bits]"	"\n\t"
+			"mov	%B[bits], %A[bits]"	"\n\t"
+			"clr	%A[bits]"			"\n\t"
+		"2:"							"\n\t"
+			"andi	%[count], 0x07"		"\n\t"
+			"breq	4f"					"\n\t"
+		"3:"							"\n\t"
+			"lsl	%A[bits]"			"\n\t"
+			"rol	%B[bits]"			"\n\t"
+			"rol	%C[bits]"			"\n\t"
+			"rol	%D[bits]"			"\n\t"
+			"dec	%[count]"			"\n\t"
+			"brne	3b"					"\n\t"
+		"4:"							"\n\t"
+			: [bits] "+r" (bits), [count] "+d" (count)
+		);
+
+		return bits;
+#else
+		return bits << count;
+#endif
+	}
+
 	//
 	// _get_mask()
 	//
@@ -310,19 +1438,113 @@ private:
 		return MASKS[bit_count];
 	}
 
-private:
-	uint32_t		m_bits[2];
-	uint8_t			m_bitCounts[2];
-	uint8_t			m_ctrlIndex;
-
 public:
 	static const uint8_t	MAX_BITS_PER_RANDOM_REQUEST = 20;
-	static const uint8_t	MAX_VALUE_PER_RANDOM_REQUEST = ((1 << MAX_BITS_PER_RANDOM_REQUEST) - 1);
+	static const long		MAX_VALUE_PER_RANDOM_REQUEST = ((1L << MAX_BITS_PER_RANDOM_REQUEST) - 1);
+
+	// randomBits16() and random16() take up to 16 bits in one request
+	static_assert(MAX_BITS_PER_RANDOM_REQUEST >= 16,
+			"MAX_BITS_PER_RANDOM_REQUEST must be at least 16");
 
 private:
-	static const uint8_t	BITS_PER_NATIVE_RANDOM = 31;
+	static const uint8_t	BITS_PER_ENGINE_WORD = engine_type::BITS_PER_WORD;
+	static const uint8_t	BYTES_PER_ENGINE_WORD = BITS_PER_ENGINE_WORD / 8;
+
+	// Engine words generated per fill() call in randomBytes()
+	static const uint8_t	WORDS_PER_BYTES_BLOCK = 8;
+
+#if RANDOMX1_POOL_LAYOUT == RANDOMX1_POOL_BYTES
+	// At least 4 bytes per pool word of depth, in whole engine words.  The
+	// count is checked before it is narrowed for fill().
+	static const uint16_t	REFILL_WORDS = ((4 + BYTES_PER_ENGINE_WORD - 1) / BYTES_PER_ENGINE_WORD) * RANDOMX1_POOL_WORDS;
+
+	static_assert(REFILL_WORDS <= 255,
+			"RANDOMX1_POOL_BYTES refills at most 255 engine words, lower RANDOMX1_POOL_WORDS for this engine");
+
+	static const uint8_t	WORDS_PER_REFILL = (uint8_t)REFILL_WORDS;
+	static const uint16_t	POOL_BYTES = WORDS_PER_REFILL * BYTES_PER_ENGINE_WORD;
+	static const uint16_t	POOL_BITS = POOL_BYTES * 8;
+
+	// _read_bits() reads at most 4 bytes, starting at any bit offset
+	static_assert(MAX_BITS_PER_RANDOM_REQUEST <= 25,
+			"RANDOMX1_POOL_BYTES supports at most 25 bits per request");
+#elif RANDOMX1_POOL_LAYOUT == RANDOMX1_POOL_STAGED
+	// Engine steps needed to top up a fully drained request
+	static const uint8_t	REFILLS_PER_REQUEST = (MAX_BITS_PER_RANDOM_REQUEST + BITS_PER_ENGINE_WORD - 1) / BITS_PER_ENGINE_WORD;
+
+#if defined(ARDUINO)
+	// Every request steps the engine and drops the bits that don't fit, too
+	// wasteful with calls to the core's random()
+	static_assert(!_randomx1_same_type<engine_type, RandomX1NativeEngine>::value,
+			"RANDOMX1_POOL_STAGED needs an engine with its own state");
+#endif
+#endif
+
+private:
+	engine_type		m_engine;
+
+#if RANDOMX1_POOL_COUNT > 1
+	uint8_t			m_ctrlIndex;
+#else
+	// Always the one pool, so pool indexing compiles away
+	static const uint8_t	m_ctrlIndex = 0;
+#endif
+
+#if RANDOMX1_POOL_LAYOUT == RANDOMX1_POOL_SHIFT
+	word_type		m_bits[RANDOMX1_POOL_COUNT];
+	uint8_t			m_bitCounts[RANDOMX1_POOL_COUNT];
+#if RANDOMX1_POOL_WORDS > 1
+	word_type		m_words[RANDOMX1_POOL_COUNT][RANDOMX1_POOL_WORDS];
+	uint8_t			m_wordIndexes[RANDOMX1_POOL_COUNT];
+#endif
+#elif RANDOMX1_POOL_LAYOUT == RANDOMX1_POOL_BYTES
+	// Padded by one byte, see _read_bits()
+	uint8_t			m_bytes[RANDOMX1_POOL_COUNT][POOL_BYTES + 1];
+	uint16_t		m_bitCursors[RANDOMX1_POOL_COUNT];
+#elif RANDOMX1_POOL_LAYOUT == RANDOMX1_POOL_STAGED
+	uint64_t		m_stages[RANDOMX1_POOL_COUNT];
+	uint8_t			m_stageCounts[RANDOMX1_POOL_COUNT];
+#endif
 };
 
+//
+// RandomX1 is the generator over the engine selected with RANDOMX1_ENGINE.
+// Code that needs a particular engine whatever RANDOMX1_ENGINE is set to
+// uses RandomX1T<> directly, e.g. RandomX1T<RandomX1Xorshift32>.
+//
+typedef RandomX1T<RANDOMX1_ENGINE>		RandomX1;
+
+//
+// _randomx1_below()
+//
+// Returns a random number between 0 (inclusive) and 'bound' (exclusive),
+// for bounds wider than RandomX1::random() takes
+//
+template<class Engine>
+static inline uint32_t _randomx1_below(RandomX1T<Engine> &rng, uint32_t bound)
+{
+	uint32_t	diff, res;
+	uint8_t		req_bits = 0;
+
+	if(bound <= (uint32_t)RandomX1T<Engine>::MAX_VALUE_PER_RANDOM_REQUEST + 1) {
+		return (uint32_t)rng.random((long)bound);
+	}
+
+	// Largest value to return
+	diff = bound - 1;
+
+	for(res = diff; res != 0; res >>= 1) {
+		req_bits++;
+	}
+
+	// 21 to 32 bits, high part first
+	do {
+		res = ((uint32_t)rng.randomBits(req_bits - 16) << 16) | rng.randomBits16(16);
+	} while(res > diff);
+
+	return res;
+}
+
 
 #endif
 
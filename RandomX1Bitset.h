@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef	RANDOM__NUS__X_1__BITSET__HEADER__FILE__
+#define	RANDOM__NUS__X_1__BITSET__HEADER__FILE__
+
+#include	<math.h>
+#include	<string.h>
+
+#include	"RandomX1.h"
+
+//
+// Below this density (in 1/65536ths, default 1/64) randomBitsetDensity()
+// jumps from set bit to set bit instead of masking every word
+//
+#ifndef	RANDOMX1_BITSET_SPARSE_DENSITY
+#define	RANDOMX1_BITSET_SPARSE_DENSITY		1024
+#endif
+
+
+/*
+ * Random bitsets in a caller-provided array of 32-bit words.  Bit 'i' is
+ * bit (i % 32) of words[i / 32].  Bits of the last word past 'bit_count' are
+ * cleared.
+ *
+ *		randomBitsetDensity()	every bit set independently with
+ *								probability p
+ *		randomBitsetCount()		exactly k bits set, every k-subset equally
+ *								likely
+ *
+ * Neither draws one randomBits(1) per bit:
+ *
+ *		- dense densities fill whole words with RandomX1::bernoulliMask32()
+ *		- sparse densities draw the geometric distance to the next set bit,
+ *		  so the cost follows the number of set bits, not the size
+ *		- exact counts use Floyd's algorithm with the bitset itself as the
+ *		  set of chosen bits, one draw per set bit; when more than half the
+ *		  bits are set the cleared bits are chosen instead
+ *
+ */
+
+//
+// _randomx1_clear_tail()
+//
+// Clears the bits of the last word past 'bit_count'
+//
+static inline void _randomx1_clear_tail(uint32_t *words, uint32_t bit_count)
+{
+	if(bit_count % 32 != 0) {
+		words[bit_count / 32] &= (((uint32_t)1) << (bit_count % 32)) - 1;
+	}
+}
+
+//
+// randomBitsetDensity()
+//
+// Fills the 'bit_count' bits of 'words' with bits that are each set with
+// probability 'p' / 2^'resolution_bits', like bernoulliMask32().
+//
+// - 'resolution_bits' is limited to 16
+// - When 'p' >= 2^'resolution_bits' all bits are set
+//
+template<class Engine>
+static inline void randomBitsetDensity(RandomX1T<Engine> &rng, uint32_t *words, uint32_t bit_count,
+		uint16_t p, uint8_t resolution_bits = 8)
+{
+	uint32_t	word_count = (bit_count + 31) / 32;
+	uint32_t	pos, r;
+	double		scale, skip;
+
+	if(resolution_bits > 16) {
+		resolution_bits = 16;
+	}
+
+	if(p == 0 || ((uint32_t)p << (16 - resolution_bits)) >= RANDOMX1_BITSET_SPARSE_DENSITY) {
+		for(uint32_t i = 0; i < word_count; i++) {
+			words[i] = rng.bernoulliMask32(p, resolution_bits);
+		}
+
+		_randomx1_clear_tail(words, bit_count);
+		return;
+	}
+
+	memset(words, 0, word_count * sizeof(uint32_t));
+
+	// Bits skipped before the next set bit are geometric:
+	// floor(ln(u) / ln(1 - p)) for u uniform in (0, 1]
+	scale = 1.0 / log(1.0 - ldexp((double)p, -resolution_bits));
+
+	for(pos = 0; ; pos++) {
+		r = ((uint32_t)rng.randomBits16(16) << 16) | rng.randomBits16(16);
+		// ldexp(r + 0.5, -32) is never 0 and rounds to at most 1
+		skip = log(ldexp((double)r + 0.5, -32)) * scale;
+
+		// Compared as a double, a long skip can be more than 32 bits
+		if(skip >= (double)(bit_count - pos)) {
+			break;
+		}
+
+		pos += (uint32_t)skip;
+		words[pos / 32] |= ((uint32_t)1) << (pos % 32);
+	}
+}
+
+//
+// randomBitsetCount()
+//
+// Clears the 'bit_count' bits of 'words' and sets exactly 'k' of them at
+// random.  When 'k' >= 'bit_count' all bits are set.
+//
+template<class Engine>
+static inline void randomBitsetCount(RandomX1T<Engine> &rng, uint32_t *words, uint32_t bit_count, uint32_t k)
+{
+	uint32_t	word_count = (bit_count + 31) / 32;
+	uint32_t	pick, t, mask;
+	bool		invert;
+
+	if(k > bit_count) {
+		k = bit_count;
+	}
+
+	// Choose whichever of the set or cleared bits are fewer
+	invert = (k > bit_count / 2);
+	pick = invert ? (bit_count - k) : k;
+
+	memset(words, 0, word_count * sizeof(uint32_t));
+
+	// Floyd: for each j, pick t in [0, j]; if t was already chosen take j,
+	// which can't have been
+	for(uint32_t j = bit_count - pick; j < bit_count; j++) {
+		t = _randomx1_below(rng, j + 1);
+		mask = ((uint32_t)1) << (t % 32);
+
+		if(words[t / 32] & mask) {
+			t = j;
+			mask = ((uint32_t)1) << (t % 32);
+		}
+
+		words[t / 32] |= mask;
+	}
+
+	if(invert) {
+		for(uint32_t i = 0; i < word_count; i++) {
+			words[i] = ~words[i];
+		}
+	}
+
+	_randomx1_clear_tail(words, bit_count);
+}
+
+
+#endif
@@ -0,0 +1,321 @@
+///////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef	RANDOM__NUS__X_1__CONSTEXPR__HEADER__FILE__
+#define	RANDOM__NUS__X_1__CONSTEXPR__HEADER__FILE__
+
+#include	"RandomX1.h"
+
+#if __cplusplus < 201402L
+#error "RandomX1Constexpr.h needs C++14 or later (-std=gnu++14)"
+#endif
+
+// Tables made at compile time must match RandomX1 at run time, and only the
+// default pool is copied here
+#if RANDOMX1_POOL_LAYOUT != RANDOMX1_POOL_SHIFT || RANDOMX1_POOL_WORDS != 1
+#error "RandomX1Constexpr.h only matches RandomX1 with RANDOMX1_POOL_SHIFT and RANDOMX1_POOL_WORDS 1"
+#endif
+
+
+/*
+ * RandomX1Constexpr is a constexpr version of RandomX1, used to generate
+ * random tables at compile time instead of in setup().  For the same engine
+ * and seed it produces exactly the same randomBits() and random() sequence
+ * as RandomX1 built with the shift pool layout and a pool depth of 1 (the
+ * defaults), with or without RANDOMX1_SINGLE_POOL.  Including it with any
+ * other RANDOMX1_POOL_LAYOUT or RANDOMX1_POOL_WORDS is an error.
+ *
+ * The native engine cannot be used, the engine defaults to xorshift32.
+ *
+ * The make*Table() functions fill a RandomX1Table, which on AVR can be put
+ * in flash:
+ *
+ *		static const RandomX1Table<uint8_t, 256> jitter PROGMEM =
+ *				makeRandomTable<uint8_t, 256>(1234, 0, 16);
+ *
+ *		uint8_t j = pgm_read_byte(&jitter.values[i]);
+ *
+ */
+template<class Engine = RandomX1Xorshift32>
+class RandomX1Constexpr
+{
+public:
+	typedef Engine						engine_type;
+	typedef typename Engine::word_type	word_type;
+
+	constexpr RandomX1Constexpr(unsigned long seed = 0)
+		: m_engine(), m_bits(), m_bitCounts(), m_ctrlIndex(0)
+	{
+		this->randomSeed(seed);
+	}
+
+	//
+	// randomSeed(), see RandomX1::randomSeed()
+	//
+	constexpr void randomSeed(unsigned long seed)
+	{
+		m_engine.seed(seed);
+
+		m_ctrlIndex = 0;
+		if(POOL_COUNT > 1) {
+			this->_refill(1);
+		}
+		this->_refill(0);
+	}
+
+	//
+	// randomBits(), see RandomX1::randomBits()
+	//
+	constexpr long randomBits(uint8_t bit_count, long offset = 0)
+	{
+		if(bit_count == 0) {
+			return 0;
+		}
+
+		// Limit requested bit count
+		if(bit_count > RandomX1::MAX_BITS_PER_RANDOM_REQUEST) {
+			bit_count = RandomX1::MAX_BITS_PER_RANDOM_REQUEST;
+		}
+
+		if(POOL_COUNT > 1) {
+			m_ctrlIndex ^= 0x01;
+		}
+		return this->_get_bits(bit_count) + offset;
+	}
+
+	//
+	// random(), see RandomX1::random()
+	//
+	constexpr long random(long min_val, long max_val)
+	{
+		long		diff = max_val - min_val - 1;
+		long		res = 0;
+		uint8_t		req_bits = 0;
+
+		if(diff <= 0) {
+			return min_val;
+		}
+
+		// Limit requested value range
+		if(diff > RandomX1::MAX_VALUE_PER_RANDOM_REQUEST) {
+			diff = RandomX1::MAX_VALUE_PER_RANDOM_REQUEST;
+		}
+
+		req_bits = this->_get_required_bits(diff);
+
+		if(POOL_COUNT == 1) {
+			do {
+				res = this->_get_bits(req_bits);
+			} while(res > diff);
+
+			return (res + min_val);
+		}
+
+		// Same tries, in the same order, as the two pool RandomX1::random()
+		res = this->randomBits(req_bits);
+
+		if(res > diff) {
+			res = this->randomBits(req_bits);
+
+			if(res > diff) {
+				if(!this->_peek_bits(req_bits, diff, res)) {
+					m_ctrlIndex ^= 0x01;
+
+					if(!this->_peek_bits(req_bits, diff, res)) {
+						do {
+							res = this->randomBits(req_bits);
+						} while(res > diff);
+					}
+				}
+			}
+		}
+
+		return (res + min_val);
+	}
+
+	//
+	// random(), without min value
+	//
+	constexpr long random(long max_val)
+	{
+		return this->random(0, max_val);
+	}
+
+private:
+	//
+	// _get_required_bits()
+	//
+	// Returns the minimum number of bits needed to represent 'num'
+	//
+	static constexpr uint8_t _get_required_bits(long num)
+	{
+		uint8_t		ret = 0;
+
+		while(num != 0) {
+			num >>= 1;
+			ret++;
+		}
+
+		return ret;
+	}
+
+	//
+	// _get_mask()
+	//
+	static constexpr uint32_t _get_mask(uint8_t bit_count)
+	{
+		return (bit_count >= 32) ? 0xffffffff : ((((uint32_t)1) << bit_count) - 1);
+	}
+
+	//
+	// _refill()
+	//
+	constexpr void _refill(uint8_t index)
+	{
+		m_bits[index] = m_engine.next();
+		m_bitCounts[index] = Engine::BITS_PER_WORD;
+	}
+
+	//
+	// _peek_bits(), see RandomX1::_peek_bits()
+	//
+	constexpr bool _peek_bits(uint8_t bit_count, long num, long &res)
+	{
+		if(m_bitCounts[m_ctrlIndex] >= bit_count) {
+			if((word_type)(m_bits[m_ctrlIndex] & this->_get_mask(bit_count)) <= num) {
+				res = this->_get_bits(bit_count);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	//
+	// _get_bits(), see RandomX1::_get_bits()
+	//
+	constexpr long _get_bits(uint8_t bit_count)
+	{
+		long		ret = 0;
+		word_type	bits = 0;
+
+		while(bit_count > m_bitCounts[m_ctrlIndex]) {
+			bit_count -= m_bitCounts[m_ctrlIndex];
+			ret |= (long)((uint32_t)m_bits[m_ctrlIndex] << bit_count);
+
+			this->_refill(m_ctrlIndex);
+		}
+
+		bits = (m_bits[m_ctrlIndex] & (word_type)this->_get_mask(bit_count));
+
+		m_bitCounts[m_ctrlIndex] -= bit_count;
+		// A whole 8 or 16-bit word can be used, shifting by its width is
+		// undefined
+		m_bits[m_ctrlIndex] = (bit_count >= sizeof(word_type) * 8) ? 0 :
+				(word_type)(m_bits[m_ctrlIndex] >> bit_count);
+		return ret | bits;
+	}
+
+private:
+	static const uint8_t	POOL_COUNT = RANDOMX1_POOL_COUNT;
+
+	Engine			m_engine;
+	word_type		m_bits[2];
+	uint8_t			m_bitCounts[2];
+	uint8_t			m_ctrlIndex;
+};
+
+//
+// RandomX1Table
+//
+// Fixed size table returned by the make*Table() functions
+//
+template<class T, uint16_t N>
+struct RandomX1Table
+{
+	T		values[N];
+
+	constexpr const T &operator[](uint16_t index) const
+	{
+		return values[index];
+	}
+};
+
+//
+// makeRandomTable()
+//
+// Returns a table of N values from RandomX1::random(min_val, max_val)
+//
+template<class T, uint16_t N, class Engine = RandomX1Xorshift32>
+constexpr RandomX1Table<T, N> makeRandomTable(unsigned long seed, long min_val, long max_val)
+{
+	RandomX1Constexpr<Engine>	rng(seed);
+	RandomX1Table<T, N>			table = {};
+
+	for(uint16_t i = 0; i < N; i++) {
+		table.values[i] = (T)rng.random(min_val, max_val);
+	}
+
+	return table;
+}
+
+//
+// makeRandomBitsTable()
+//
+// Returns a table of N values from RandomX1::randomBits(bit_count, offset)
+//
+template<class T, uint16_t N, class Engine = RandomX1Xorshift32>
+constexpr RandomX1Table<T, N> makeRandomBitsTable(unsigned long seed, uint8_t bit_count, long offset = 0)
+{
+	RandomX1Constexpr<Engine>	rng(seed);
+	RandomX1Table<T, N>			table = {};
+
+	for(uint16_t i = 0; i < N; i++) {
+		table.values[i] = (T)rng.randomBits(bit_count, offset);
+	}
+
+	return table;
+}
+
+//
+// makeShuffleTable()
+//
+// Returns a random permutation of 0 to N - 1 (Fisher-Yates, drawing with
+// random(i + 1))
+//
+template<class T, uint16_t N, class Engine = RandomX1Xorshift32>
+constexpr RandomX1Table<T, N> makeShuffleTable(unsigned long seed)
+{
+	RandomX1Constexpr<Engine>	rng(seed);
+	RandomX1Table<T, N>			table = {};
+	T							temp = 0;
+	uint16_t					j = 0;
+
+	for(uint16_t i = 0; i < N; i++) {
+		table.values[i] = (T)i;
+	}
+
+	for(uint16_t i = N - 1; i > 0; i--) {
+		j = (uint16_t)rng.random(i + 1);
+		temp = table.values[i];
+		table.values[i] = table.values[j];
+		table.values[j] = temp;
+	}
+
+	return table;
+}
+
+
+#endif
@@ -0,0 +1,412 @@
+///////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef	RANDOM__NUS__X_1__ENGINES__HEADER__FILE__
+#define	RANDOM__NUS__X_1__ENGINES__HEADER__FILE__
+
+#include	<stdint.h>
+#include	<limits.h>
+
+//
+// constexpr for functions that need C++14 relaxed constexpr (loops, several
+// statements), empty otherwise
+//
+#if __cplusplus >= 201402L
+#define	RANDOMX1_CONSTEXPR		constexpr
+#else
+#define	RANDOMX1_CONSTEXPR
+#endif
+
+/*
+ * Generator engines used to fill the RandomX1 bit pool.
+ *
+ * Every engine has the same small interface:
+ *
+ *		word_type		unsigned type of one generated word, this is also
+ *						the type of the RandomX1 pool words
+ *		BITS_PER_WORD	number of random bits in each word
+ *		MIN_WORD		smallest value next() can return
+ *		MAX_WORD		largest value next() can return
+ *		seed()			set a new seed
+ *		next()			generate one word
+ *		fill()			generate several words in one call; the state is
+ *						loaded and stored once instead of once per word
+ *
+ * Except for the native engine, all of these are constexpr when compiled as
+ * C++14 or later, so they can also generate tables at compile time (see
+ * RandomX1Constexpr.h).
+ *
+ * The engine of RandomX1 is selected by defining RANDOMX1_ENGINE to one of
+ * the class names below before including RandomX1.h.  The default is the C
+ * library random() on Arduino and xorshift32 elsewhere.  RandomX1T<> takes
+ * any of them directly, e.g. RandomX1T<RandomX1Jsf8>.
+ *
+ * The 8 and 16-bit engines are meant for the smallest AVR parts (ATtiny),
+ * where every 32-bit operation costs four times the register traffic.  Their
+ * pool words are 8 or 16 bits wide, so randomBits() requests that fit within
+ * a word never need 32-bit shifts or masks.  They have short periods and are
+ * only suitable for things like visual effects and jitter.
+ *
+ *		Engine					Word	Period
+ *		RandomX1NativeEngine	31		2^31 - 2 (avr-libc Park-Miller)
+ *		RandomX1Xorshift32		32		2^32 - 1
+ *		RandomX1Xorshift16		16		2^16 - 1
+ *		RandomX1Xorshift8		8		2^8 - 1
+ *		RandomX1Jsf8			8		seed dependent
+ *		RandomX1Lfsr8			8		2^8 - 1
+ *
+ */
+
+//
+// randomx1_fold8()
+//
+// XOR the four bytes of 'seed' together, used to seed the 8-bit engines
+//
+static RANDOMX1_CONSTEXPR inline uint8_t randomx1_fold8(unsigned long seed)
+{
+	return (uint8_t)(seed ^ (seed >> 8) ^ (seed >> 16) ^ (seed >> 24));
+}
+
+#if defined(ARDUINO)
+//
+// RandomX1NativeEngine
+//
+// The C library random(), 31 bits per word.  Only available on Arduino.
+//
+// This calls the C library's random() and srandom() directly rather than
+// the Arduino random(long) and randomSeed() wrappers, so it still works when
+// those are replaced by RandomX1Override.h, and skips the 32-bit modulo the
+// wrapper does on every call.
+//
+class RandomX1NativeEngine
+{
+public:
+	typedef uint32_t	word_type;
+
+	static const uint8_t	BITS_PER_WORD = 31;
+	static const word_type	MIN_WORD = 0;
+	// RANDOM_MAX
+	static const word_type	MAX_WORD = 0x7fffffff;
+
+	inline void seed(unsigned long seed)
+	{
+		// Same as ::randomSeed(), a zero seed leaves the sequence alone
+		if(seed != 0) {
+			::srandom(seed);
+		}
+	}
+
+	inline word_type next()
+	{
+		return ::random();
+	}
+
+	inline void fill(word_type *words, uint8_t count)
+	{
+		for(uint8_t i = 0; i < count; i++) {
+			words[i] = ::random();
+		}
+	}
+};
+#endif
+
+//
+// RandomX1Xorshift32
+//
+// Marsaglia xorshift, shift triple (13, 17, 5).  Never returns 0.
+//
+class RandomX1Xorshift32
+{
+public:
+	typedef uint32_t	word_type;
+
+	static const uint8_t	BITS_PER_WORD = 32;
+	static const word_type	MIN_WORD = 1;
+	static const word_type	MAX_WORD = 0xffffffff;
+
+	RANDOMX1_CONSTEXPR RandomX1Xorshift32()
+		: m_state(0)
+	{
+		this->seed(0);
+	}
+
+	RANDOMX1_CONSTEXPR inline void seed(unsigned long seed)
+	{
+		// A zero state would only ever generate zeros
+		m_state = (seed != 0) ? (uint32_t)seed : 0x92d68ca2;
+	}
+
+	RANDOMX1_CONSTEXPR inline word_type next()
+	{
+		m_state ^= m_state << 13;
+		m_state ^= m_state >> 17;
+		m_state ^= m_state << 5;
+		return m_state;
+	}
+
+	RANDOMX1_CONSTEXPR inline void fill(word_type *words, uint8_t count)
+	{
+		uint32_t	state = m_state;
+
+		for(uint8_t i = 0; i < count; i++) {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			words[i] = state;
+		}
+
+		m_state = state;
+	}
+
+private:
+	uint32_t		m_state;
+};
+
+//
+// RandomX1Xorshift16
+//
+// 16-bit xorshift, shift triple (7, 9, 8).  Never returns 0.
+//
+class RandomX1Xorshift16
+{
+public:
+	typedef uint16_t	word_type;
+
+	static const uint8_t	BITS_PER_WORD = 16;
+	static const word_type	MIN_WORD = 1;
+	static const word_type	MAX_WORD = 0xffff;
+
+	RANDOMX1_CONSTEXPR RandomX1Xorshift16()
+		: m_state(0)
+	{
+		this->seed(0);
+	}
+
+	RANDOMX1_CONSTEXPR inline void seed(unsigned long seed)
+	{
+		m_state = (uint16_t)(seed ^ (seed >> 16));
+
+		if(m_state == 0) {
+			m_state = 0x8ca2;
+		}
+	}
+
+	RANDOMX1_CONSTEXPR inline word_type next()
+	{
+		m_state ^= (uint16_t)(m_state << 7);
+		m_state ^= (uint16_t)(m_state >> 9);
+		m_state ^= (uint16_t)(m_state << 8);
+		return m_state;
+	}
+
+	RANDOMX1_CONSTEXPR inline void fill(word_type *words, uint8_t count)
+	{
+		uint16_t	state = m_state;
+
+		for(uint8_t i = 0; i < count; i++) {
+			state ^= (uint16_t)(state << 7);
+			state ^= (uint16_t)(state >> 9);
+			state ^= (uint16_t)(state << 8);
+			words[i] = state;
+		}
+
+		m_state = state;
+	}
+
+private:
+	uint16_t		m_state;
+};
+
+//
+// RandomX1Xorshift8
+//
+// 8-bit xorshift, shift triple (3, 5, 4).  Never returns 0.
+//
+class RandomX1Xorshift8
+{
+public:
+	typedef uint8_t		word_type;
+
+	static const uint8_t	BITS_PER_WORD = 8;
+	static const word_type	MIN_WORD = 1;
+	static const word_type	MAX_WORD = 0xff;
+
+	RANDOMX1_CONSTEXPR RandomX1Xorshift8()
+		: m_state(0)
+	{
+		this->seed(0);
+	}
+
+	RANDOMX1_CONSTEXPR inline void seed(unsigned long seed)
+	{
+		m_state = randomx1_fold8(seed);
+
+		if(m_state == 0) {
+			m_state = 0xa2;
+		}
+	}
+
+	RANDOMX1_CONSTEXPR inline word_type next()
+	{
+		m_state ^= (uint8_t)(m_state << 3);
+		m_state ^= (uint8_t)(m_state >> 5);
+		m_state ^= (uint8_t)(m_state << 4);
+		return m_state;
+	}
+
+	RANDOMX1_CONSTEXPR inline void fill(word_type *words, uint8_t count)
+	{
+		uint8_t		state = m_state;
+
+		for(uint8_t i = 0; i < count; i++) {
+			state ^= (uint8_t)(state << 3);
+			state ^= (uint8_t)(state >> 5);
+			state ^= (uint8_t)(state << 4);
+			words[i] = state;
+		}
+
+		m_state = state;
+	}
+
+private:
+	uint8_t			m_state;
+};
+
+//
+// RandomX1Jsf8
+//
+// Bob Jenkins' small fast generator scaled to 8-bit words (rotations 1 and
+// 4).  The period depends on the seed; only 256 distinct seeds are used since
+// the seed is folded into the 8-bit b, c and d words.
+//
+class RandomX1Jsf8
+{
+public:
+	typedef uint8_t		word_type;
+
+	static const uint8_t	BITS_PER_WORD = 8;
+	static const word_type	MIN_WORD = 0;
+	static const word_type	MAX_WORD = 0xff;
+
+	RANDOMX1_CONSTEXPR RandomX1Jsf8()
+		: m_a(0), m_b(0), m_c(0), m_d(0)
+	{
+		this->seed(0);
+	}
+
+	RANDOMX1_CONSTEXPR inline void seed(unsigned long seed)
+	{
+		m_a = 0xf1;
+		m_b = m_c = m_d = randomx1_fold8(seed);
+
+		for(uint8_t i = 0; i < 20; i++) {
+			this->next();
+		}
+	}
+
+	RANDOMX1_CONSTEXPR inline word_type next()
+	{
+		uint8_t		e = m_a - (uint8_t)((m_b << 1) | (m_b >> 7));
+
+		m_a = m_b ^ (uint8_t)((m_c << 4) | (m_c >> 4));
+		m_b = m_c + m_d;
+		m_c = m_d + e;
+		m_d = e + m_a;
+		return m_d;
+	}
+
+	RANDOMX1_CONSTEXPR inline void fill(word_type *words, uint8_t count)
+	{
+		uint8_t		a = m_a, b = m_b, c = m_c, d = m_d, e = 0;
+
+		for(uint8_t i = 0; i < count; i++) {
+			e = a - (uint8_t)((b << 1) | (b >> 7));
+			a = b ^ (uint8_t)((c << 4) | (c >> 4));
+			b = c + d;
+			c = d + e;
+			d = e + a;
+			words[i] = d;
+		}
+
+		m_a = a;
+		m_b = b;
+		m_c = c;
+		m_d = d;
+	}
+
+private:
+	uint8_t			m_a;
+	uint8_t			m_b;
+	uint8_t			m_c;
+	uint8_t			m_d;
+};
+
+//
+// RandomX1Lfsr8
+//
+// 8-bit Galois LFSR, taps 0xb8 (x^8 + x^6 + x^5 + x^4 + 1).  One word is 8
+// shifts of the register, so the output bytes are consecutive windows of the
+// maximal length sequence.  The cheapest engine in code size, but also the
+// weakest.  Never returns 0.
+//
+class RandomX1Lfsr8
+{
+public:
+	typedef uint8_t		word_type;
+
+	static const uint8_t	BITS_PER_WORD = 8;
+	static const word_type	MIN_WORD = 1;
+	static const word_type	MAX_WORD = 0xff;
+
+	RANDOMX1_CONSTEXPR RandomX1Lfsr8()
+		: m_state(0)
+	{
+		this->seed(0);
+	}
+
+	RANDOMX1_CONSTEXPR inline void seed(unsigned long seed)
+	{
+		m_state = randomx1_fold8(seed);
+
+		if(m_state == 0) {
+			m_state = 0xa2;
+		}
+	}
+
+	RANDOMX1_CONSTEXPR inline word_type next()
+	{
+		uint8_t		ret = 0;
+
+		for(uint8_t i = 0; i < 8; i++) {
+			ret = (ret << 1) | (m_state & 0x01);
+			m_state = (m_state >> 1) ^ ((m_state & 0x01) ? 0xb8 : 0x00);
+		}
+
+		return ret;
+	}
+
+	RANDOMX1_CONSTEXPR inline void fill(word_type *words, uint8_t count)
+	{
+		for(uint8_t i = 0; i < count; i++) {
+			words[i] = this->next();
+		}
+	}
+
+private:
+	uint8_t			m_state;
+};
+
+
+#endif
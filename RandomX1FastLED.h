@@ -0,0 +1,158 @@
+///////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef	RANDOM__NUS__X_1__FASTLED__HEADER__FILE__
+#define	RANDOM__NUS__X_1__FASTLED__HEADER__FILE__
+
+#include	"RandomX1.h"
+
+// FastLED's lib8tion/random8.h include guard
+#if defined(__INC_LIB8TION_RANDOM_H)
+#error "RandomX1FastLED.h must be included before FastLED.h"
+#endif
+
+#define	__INC_LIB8TION_RANDOM_H
+
+
+/*
+ * FastLED random8() / random16() family on a RandomX1.
+ *
+ * Include this before FastLED.h in every file that uses these functions.
+ * It takes the place of FastLED's lib8tion/random8.h, so effect code keeps
+ * calling random8(), random16(lim), random16_add_entropy() and so on
+ * unchanged:
+ *
+ *		#include <RandomX1FastLED.h>
+ *		#include <FastLED.h>
+ *
+ * The values come from randomx1_fastled(), a single
+ * RandomX1T<RandomX1Xorshift32> shared by every file, using the 8 and 16-bit
+ * paths of RandomX1 (randomBits8(), random8(), ...), so nothing is promoted
+ * to long.  It has its own engine whatever RANDOMX1_ENGINE is set to, so
+ * random16_set_seed() never re-seeds the C library random() behind the
+ * Arduino random(), and like FastLED a seed of 0 is a seed like any other.
+ *
+ * Differences from FastLED:
+ *
+ *		- random8(lim) and random16(lim) are unbiased (rejection) instead
+ *		  of scaling a full draw with (r * lim) >> 8
+ *		- random8(min, lim) returns 'min' when 'lim' <= 'min' instead of
+ *		  wrapping around
+ *		- random16_get_seed() returns the 16-bit seed last set, with any
+ *		  entropy added, not the generator state
+ *
+ * FastLED's own .cpp files that use random8() still get FastLED's version.
+ *
+ */
+
+//
+// randomx1_fastled()
+//
+// The generator behind the functions below, created on first use
+//
+inline RandomX1T<RandomX1Xorshift32> &randomx1_fastled()
+{
+	static RandomX1T<RandomX1Xorshift32>	rng;
+
+	return rng;
+}
+
+//
+// _randomx1_fastled_seed()
+//
+inline uint16_t &_randomx1_fastled_seed()
+{
+	static uint16_t		seed = 0;
+
+	return seed;
+}
+
+//
+// random8()
+//
+// Returns a random 8-bit number, or one between 'min' (inclusive) and
+// 'lim' (exclusive)
+//
+static inline uint8_t random8()
+{
+	return randomx1_fastled().randomBits8(8);
+}
+
+static inline uint8_t random8(uint8_t lim)
+{
+	return randomx1_fastled().random8(lim);
+}
+
+static inline uint8_t random8(uint8_t min, uint8_t lim)
+{
+	return randomx1_fastled().random8(min, lim);
+}
+
+//
+// random16()
+//
+// Returns a random 16-bit number, or one between 'min' (inclusive) and
+// 'lim' (exclusive)
+//
+static inline uint16_t random16()
+{
+	return randomx1_fastled().randomBits16(16);
+}
+
+static inline uint16_t random16(uint16_t lim)
+{
+	return randomx1_fastled().random16(lim);
+}
+
+static inline uint16_t random16(uint16_t min, uint16_t lim)
+{
+	return randomx1_fastled().random16(min, lim);
+}
+
+//
+// random16_set_seed()
+//
+static inline void random16_set_seed(uint16_t seed)
+{
+	_randomx1_fastled_seed() = seed;
+	randomx1_fastled().randomSeed(seed);
+}
+
+//
+// random16_get_seed()
+//
+static inline uint16_t random16_get_seed()
+{
+	return _randomx1_fastled_seed();
+}
+
+//
+// random16_add_entropy()
+//
+// Adds 'entropy' to the seed and re-seeds.  The upper half of the new seed
+// is drawn from the current sequence, so the result also depends on how far
+// the sequence had got.
+//
+static inline void random16_add_entropy(uint16_t entropy)
+{
+	RandomX1T<RandomX1Xorshift32>	&rng = randomx1_fastled();
+	uint16_t						&seed = _randomx1_fastled_seed();
+
+	seed += entropy;
+	rng.randomSeed(((unsigned long)rng.randomBits16(16) << 16) | seed);
+}
+
+
+#endif
@@ -0,0 +1,223 @@
+///////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef	RANDOM__NUS__X_1__HASH__HEADER__FILE__
+#define	RANDOM__NUS__X_1__HASH__HEADER__FILE__
+
+#include	"RandomX1.h"
+
+
+/*
+ * RandomX1Hash is a stateless random number generator: the value for a
+ * coordinate (x, y, t) only depends on the seed and the coordinate, so any
+ * pixel of any frame can be computed on its own, in any order, as often as
+ * needed:
+ *
+ *		RandomX1Hash	sparkle(1234);
+ *
+ *		// The same pixel gets the same value every time frame 't' is drawn
+ *		uint8_t	level = sparkle.randomBits(8, x, y, t);
+ *
+ * randomBits() and random() have the same semantics and limits as the
+ * RandomX1 versions, with the coordinate added at the end.  There is no
+ * random(max_val) overload, it would be ambiguous with random(min_val,
+ * max_val, x).
+ *
+ * The hash is the coordinates scaled by large odd constants and summed, then
+ * mixed with the murmur3 32-bit finalizer, so every output bit depends on
+ * every coordinate bit.  That is 5 32-bit multiplies per value, cheap on
+ * hosts and 32-bit boards but not on AVR, where RandomX1 is the better
+ * choice whenever values can be generated in order.
+ *
+ * All functions are constexpr under C++14, so fixed patterns can also be
+ * generated at compile time.
+ *
+ */
+class RandomX1Hash
+{
+public:
+	RANDOMX1_CONSTEXPR RandomX1Hash(unsigned long seed = 0)
+		: m_seed(0)
+	{
+		this->randomSeed(seed);
+	}
+
+	//
+	// randomSeed()
+	//
+	// Set a new seed, every coordinate gets a new value
+	//
+	RANDOMX1_CONSTEXPR void randomSeed(unsigned long seed)
+	{
+		m_seed = _mix((uint32_t)seed);
+	}
+
+	//
+	// hash()
+	//
+	// Returns the 32 random bits of coordinate (x, y, t)
+	//
+	RANDOMX1_CONSTEXPR inline uint32_t hash(int32_t x, int32_t y = 0, int32_t t = 0) const
+	{
+		return this->_hash(x, y, t, 0);
+	}
+
+	//
+	// randomBits()
+	//
+	// Returns a random number between 0 (inclusive) and 2^bits (exclusive)
+	// for coordinate (x, y, t).  Like RandomX1::randomBits():
+	//
+	// - When 'bit_count' == 0, 0 is always returned
+	// - 'bit_count' is limited to RandomX1::MAX_BITS_PER_RANDOM_REQUEST
+	//
+	RANDOMX1_CONSTEXPR inline long randomBits(uint8_t bit_count, int32_t x, int32_t y = 0, int32_t t = 0) const
+	{
+		if(bit_count == 0) {
+			return 0;
+		}
+
+		if(bit_count > RandomX1::MAX_BITS_PER_RANDOM_REQUEST) {
+			bit_count = RandomX1::MAX_BITS_PER_RANDOM_REQUEST;
+		}
+
+		// The top bits are the best mixed
+		return (long)(this->_hash(x, y, t, 0) >> (32 - bit_count));
+	}
+
+	//
+	// random()
+	//
+	// Returns a random number between 'min_val' (inclusive) and 'max_val'
+	// (exclusive) for coordinate (x, y, t).  Like RandomX1::random() the
+	// range is limited to RandomX1::MAX_VALUE_PER_RANDOM_REQUEST + 1 and
+	// 'min_val' is returned when 'max_val' <= 'min_val' + 1.
+	//
+	// Out of range values are rejected as in RandomX1::random(); the next
+	// try uses the following bits of the hash, then the hash of the same
+	// coordinate with a new round number, so the result is still a function
+	// of the coordinate only.
+	//
+	RANDOMX1_CONSTEXPR inline long random(long min_val, long max_val, int32_t x, int32_t y = 0, int32_t t = 0) const
+	{
+		long		diff = max_val - min_val - 1;
+		uint32_t	bits = 0, res = 0;
+		uint8_t		req_bits = 0, available = 0;
+		uint32_t	round = 0;
+
+		if(diff <= 0) {
+			return min_val;
+		}
+
+		if(diff > RandomX1::MAX_VALUE_PER_RANDOM_REQUEST) {
+			diff = RandomX1::MAX_VALUE_PER_RANDOM_REQUEST;
+		}
+
+		for(long num = diff; num != 0; num >>= 1) {
+			req_bits++;
+		}
+
+		do {
+			if(available < req_bits) {
+				bits = this->_hash(x, y, t, round++);
+				available = 32;
+			}
+
+			// Top bits first
+			res = bits >> (32 - req_bits);
+			bits <<= req_bits;
+			available -= req_bits;
+		} while(res > (uint32_t)diff);
+
+		return (long)res + min_val;
+	}
+
+	//
+	// randomBitsRow()
+	//
+	// Writes randomBits(bit_count, x + i, y, t) to out[i] for 'count'
+	// consecutive pixels of a row.  The loop has no dependencies between
+	// pixels, so compilers vectorize it on hosts.
+	//
+	template<class T>
+	void randomBitsRow(T *out, size_t count, uint8_t bit_count, int32_t x, int32_t y = 0, int32_t t = 0) const
+	{
+		uint32_t	base;
+		uint8_t		shift;
+
+		if(bit_count == 0) {
+			memset(out, 0, count * sizeof(T));
+			return;
+		}
+
+		if(bit_count > RandomX1::MAX_BITS_PER_RANDOM_REQUEST) {
+			bit_count = RandomX1::MAX_BITS_PER_RANDOM_REQUEST;
+		}
+
+		// Everything but x is the same along the row
+		base = this->_base(y, t, 0);
+		shift = 32 - bit_count;
+
+		for(size_t i = 0; i < count; i++) {
+			out[i] = (T)(_mix(base + ((uint32_t)x + (uint32_t)i) * X_FACTOR) >> shift);
+		}
+	}
+
+private:
+	//
+	// _mix()
+	//
+	// murmur3 32-bit finalizer
+	//
+	static RANDOMX1_CONSTEXPR inline uint32_t _mix(uint32_t h)
+	{
+		h ^= h >> 16;
+		h *= 0x85ebca6b;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35;
+		h ^= h >> 16;
+		return h;
+	}
+
+	//
+	// _base()
+	//
+	// The part of the hash input that doesn't depend on x
+	//
+	RANDOMX1_CONSTEXPR inline uint32_t _base(int32_t y, int32_t t, uint32_t round) const
+	{
+		return m_seed + (uint32_t)y * Y_FACTOR + (uint32_t)t * T_FACTOR + round * ROUND_FACTOR;
+	}
+
+	//
+	// _hash()
+	//
+	RANDOMX1_CONSTEXPR inline uint32_t _hash(int32_t x, int32_t y, int32_t t, uint32_t round) const
+	{
+		return _mix(this->_base(y, t, round) + (uint32_t)x * X_FACTOR);
+	}
+
+private:
+	// Large odd constants, one per coordinate
+	static const uint32_t	X_FACTOR = 0x9e3779b1;
+	static const uint32_t	Y_FACTOR = 0x85ebca77;
+	static const uint32_t	T_FACTOR = 0xc2b2ae3d;
+	static const uint32_t	ROUND_FACTOR = 0x27d4eb2f;
+
+	uint32_t		m_seed;
+};
+
+
+#endif
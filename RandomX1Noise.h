@@ -0,0 +1,348 @@
+///////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef	RANDOM__NUS__X_1__NOISE__HEADER__FILE__
+#define	RANDOM__NUS__X_1__NOISE__HEADER__FILE__
+
+#include	"RandomX1.h"
+
+//
+// Number of Voss-McCartney rows in RandomX1PinkNoise.  Each row adds an
+// octave at the bottom of the pink range, the lowest reaches about
+// sample_rate / 2^(rows + 1).
+//
+#ifndef	RANDOMX1_PINK_ROWS
+#define	RANDOMX1_PINK_ROWS		12
+#endif
+
+//
+// RandomX1BrownNoise leak, the integrator loses 1/2^shift of its value every
+// sample so it doesn't drift off.  The spectrum flattens below about
+// sample_rate / (2 pi 2^shift).
+//
+#ifndef	RANDOMX1_BROWN_LEAK_SHIFT
+#define	RANDOMX1_BROWN_LEAK_SHIFT		6
+#endif
+
+//
+// 32-bit words generated per randomBytes() call by the dither functions, on
+// the stack.  Kept small on AVR, where they may run in an ISR.
+//
+#ifndef	RANDOMX1_DITHER_BLOCK_WORDS
+#if defined(__AVR__)
+#define	RANDOMX1_DITHER_BLOCK_WORDS		4
+#else
+#define	RANDOMX1_DITHER_BLOCK_WORDS		64
+#endif
+#endif
+
+
+/*
+ * Pink (1/f) and brown (1/f^2) noise as signed 16-bit samples, one sample per
+ * next() call or a block per fill() call, e.g. from a DAC or PWM timer ISR,
+ * and blocks of TPDF or RPDF dither for requantizing audio samples.
+ *
+ * All take their random bits from a RandomX1 passed to the constructor or
+ * function, which must outlive them.  Nothing is allocated and no floating
+ * point is used.  If the RandomX1 is used from an ISR, don't also use it from
+ * the main loop.
+ *
+ */
+
+//
+// RandomX1PinkNoise
+//
+// Voss-McCartney: the output is the sum of RANDOMX1_PINK_ROWS rows plus a
+// white value.  Row 'n' is redrawn every 2^(n+1) samples, so only one row
+// changes per sample; which one is the number of trailing zeros of a sample
+// counter.  That is two pool draws per sample, the row and the white value,
+// no matter how many rows there are.
+//
+// Rows and the white value are uniform 12-bit values, so the output stays
+// within +-2048 * (RANDOMX1_PINK_ROWS + 1), +-26624 with the default 12 rows.
+//
+class RandomX1PinkNoise
+{
+public:
+	RandomX1PinkNoise(RandomX1 &rng)
+		: m_rng(rng)
+	{
+		this->reset();
+	}
+
+	//
+	// reset()
+	//
+	// Draws new values for all rows and restarts the counter
+	//
+	void reset()
+	{
+		m_sum = 0;
+		m_counter = 0;
+
+		for(uint8_t i = 0; i < ROWS; i++) {
+			m_rows[i] = this->_draw();
+			m_sum += m_rows[i];
+		}
+	}
+
+	//
+	// next()
+	//
+	// Returns the next sample
+	//
+	inline int16_t next()
+	{
+		uint16_t	counter = ++m_counter;
+		uint8_t		row = 0;
+
+		// Trailing zeros select the row, none of them when the counter wraps
+		if(counter != 0) {
+			while((counter & 0x01) == 0) {
+				counter >>= 1;
+				row++;
+			}
+
+			if(row < ROWS) {
+				m_sum -= m_rows[row];
+				m_rows[row] = this->_draw();
+				m_sum += m_rows[row];
+			}
+		}
+
+		return m_sum + this->_draw();
+	}
+
+	//
+	// fill()
+	//
+	// Writes the next 'count' samples to 'buffer'
+	//
+	void fill(int16_t *buffer, size_t count)
+	{
+		for(size_t i = 0; i < count; i++) {
+			buffer[i] = this->next();
+		}
+	}
+
+private:
+	//
+	// _draw()
+	//
+	// Returns a uniform value in -2048 to 2047
+	//
+	inline int16_t _draw()
+	{
+		return (int16_t)m_rng.randomBits16(ROW_BITS) - (int16_t)(1 << (ROW_BITS - 1));
+	}
+
+private:
+	static const uint8_t	ROWS = RANDOMX1_PINK_ROWS;
+	static const uint8_t	ROW_BITS = 12;
+
+	// The sum of all rows and the white value must fit in an int16_t
+	static_assert(RANDOMX1_PINK_ROWS >= 1 && RANDOMX1_PINK_ROWS <= 15,
+			"RANDOMX1_PINK_ROWS must be 1 to 15");
+
+	RandomX1		&m_rng;
+	int16_t			m_rows[RANDOMX1_PINK_ROWS];
+	int16_t			m_sum;
+	uint16_t		m_counter;
+};
+
+//
+// RandomX1BrownNoise
+//
+// Leaky integration of uniform 12-bit white noise, one pool draw per sample.
+// The integrator keeps 8 fraction bits so the leak doesn't round away small
+// values.  With the default leak the standard deviation is about 6700 and
+// the rare samples past the int16_t range are clamped.
+//
+class RandomX1BrownNoise
+{
+public:
+	RandomX1BrownNoise(RandomX1 &rng)
+		: m_rng(rng)
+	{
+		this->reset();
+	}
+
+	//
+	// reset()
+	//
+	// Restarts from 0
+	//
+	void reset()
+	{
+		m_level = 0;
+	}
+
+	//
+	// next()
+	//
+	// Returns the next sample
+	//
+	inline int16_t next()
+	{
+		int32_t		step = (int32_t)m_rng.randomBits16(12) - 2048;
+		int32_t		res;
+
+		m_level += step * 256;
+		m_level -= m_level / (1L << RANDOMX1_BROWN_LEAK_SHIFT);
+
+		res = m_level / 256;
+
+		if(res > INT16_MAX) {
+			return INT16_MAX;
+		}
+		else if(res < INT16_MIN) {
+			return INT16_MIN;
+		}
+
+		return (int16_t)res;
+	}
+
+	//
+	// fill()
+	//
+	// Writes the next 'count' samples to 'buffer'
+	//
+	void fill(int16_t *buffer, size_t count)
+	{
+		for(size_t i = 0; i < count; i++) {
+			buffer[i] = this->next();
+		}
+	}
+
+private:
+	RandomX1		&m_rng;
+	// Integrator, 8 fraction bits
+	int32_t			m_level;
+};
+
+//
+// randomDitherTPDF(), randomDitherRPDF()
+//
+// Fill 'buffer' with 'count' dither values, to be added to samples before
+// they are truncated to a coarser resolution.  'bits' is the size of the
+// target LSB in buffer units, as a power of 2: e.g. 8 when 24-bit samples
+// held in an int32_t are truncated to 16 bits.  When 'bits' is 0 the buffer
+// is cleared.
+//
+//		TPDF	triangular, -2^bits to 2^bits exclusive, mean 0
+//		RPDF	uniform, -2^(bits-1) to 2^(bits-1) exclusive, mean -1/2
+//
+// The random bits are taken as whole 32-bit words with randomBytes(), a
+// block of RANDOMX1_DITHER_BLOCK_WORDS at a time, bypassing the bit pool.
+// Each word gives two samples: its 16-bit halves 'a' and 'b' (masked to
+// 'bits') become a - b and a + b - (2^bits - 1) for TPDF, or one sample
+// each for RPDF.  The sum and difference of two uniforms are each
+// triangular and uncorrelated with each other, so the dither stays white.
+// The loops over a block have no dependencies between words, so compilers
+// vectorize them on hosts.
+//
+// To refill one half of a ping-pong DMA buffer while the other is played:
+//
+//		void onHalfDone(uint8_t half)
+//		{
+//			randomDitherTPDF(rng, &dither[half * HALF], HALF, 8);
+//		}
+//
+// - 'bits' is limited to 15 for int16_t buffers and 16 for int32_t
+//
+template<class T, class Engine>
+void randomDitherTPDF(RandomX1T<Engine> &rng, T *buffer, size_t count, uint8_t bits = 1)
+{
+	uint32_t	words[RANDOMX1_DITHER_BLOCK_WORDS];
+	uint32_t	mask;
+	size_t		word_count;
+
+	if(bits > ((sizeof(T) == 2) ? 15 : 16)) {
+		bits = (sizeof(T) == 2) ? 15 : 16;
+	}
+
+	mask = ((uint32_t)1 << bits) - 1;
+
+	while(count > 0) {
+		word_count = count / 2;
+
+		if(word_count > RANDOMX1_DITHER_BLOCK_WORDS) {
+			word_count = RANDOMX1_DITHER_BLOCK_WORDS;
+		}
+
+		if(word_count == 0) {
+			// Odd count, one sample left
+			rng.randomBytes((uint8_t *)words, sizeof(uint32_t));
+			*buffer = (T)((int32_t)(words[0] & mask) - (int32_t)((words[0] >> 16) & mask));
+			break;
+		}
+
+		rng.randomBytes((uint8_t *)words, word_count * sizeof(uint32_t));
+
+		for(size_t i = 0; i < word_count; i++) {
+			int32_t		a = (int32_t)(words[i] & mask);
+			int32_t		b = (int32_t)((words[i] >> 16) & mask);
+
+			buffer[2 * i] = (T)(a - b);
+			buffer[2 * i + 1] = (T)(a + b - (int32_t)mask);
+		}
+
+		buffer += word_count * 2;
+		count -= word_count * 2;
+	}
+}
+
+template<class T, class Engine>
+void randomDitherRPDF(RandomX1T<Engine> &rng, T *buffer, size_t count, uint8_t bits = 1)
+{
+	uint32_t	words[RANDOMX1_DITHER_BLOCK_WORDS];
+	uint32_t	mask;
+	int32_t		half;
+	size_t		word_count;
+
+	if(bits > 16) {
+		bits = 16;
+	}
+
+	mask = ((uint32_t)1 << bits) - 1;
+	half = (int32_t)((mask + 1) >> 1);
+
+	while(count > 0) {
+		word_count = count / 2;
+
+		if(word_count > RANDOMX1_DITHER_BLOCK_WORDS) {
+			word_count = RANDOMX1_DITHER_BLOCK_WORDS;
+		}
+
+		if(word_count == 0) {
+			// Odd count, one sample left
+			rng.randomBytes((uint8_t *)words, sizeof(uint32_t));
+			*buffer = (T)((int32_t)(words[0] & mask) - half);
+			break;
+		}
+
+		rng.randomBytes((uint8_t *)words, word_count * sizeof(uint32_t));
+
+		for(size_t i = 0; i < word_count; i++) {
+			buffer[2 * i] = (T)((int32_t)(words[i] & mask) - half);
+			buffer[2 * i + 1] = (T)((int32_t)((words[i] >> 16) & mask) - half);
+		}
+
+		buffer += word_count * 2;
+		count -= word_count * 2;
+	}
+}
+
+#endif
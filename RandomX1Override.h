@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef	RANDOM__NUS__X_1__OVERRIDE__HEADER__FILE__
+#define	RANDOM__NUS__X_1__OVERRIDE__HEADER__FILE__
+
+#if !defined(ARDUINO)
+#error "RandomX1Override.h replaces the Arduino random() functions, it is for Arduino builds only"
+#endif
+
+#include	"RandomX1.h"
+
+
+/*
+ * Replaces the Arduino random(long), random(long, long) and randomSeed()
+ * with versions backed by a global RandomX1 generator, so every library in
+ * the firmware that calls random() gets the faster generator, not just the
+ * sketch.
+ *
+ * This header holds the definitions, not just declarations.  Include it in
+ * exactly one .ino or .cpp file of the sketch:
+ *
+ *		#include <RandomX1Override.h>
+ *
+ * The sketch's objects are linked before the core library, so the linker
+ * takes these definitions and never pulls in the core's WMath.o.  WMath.o
+ * also holds map() and makeWord(), which on AVR are defined here too so a
+ * sketch that uses them doesn't pull it in after all.  On other cores using
+ * map() or makeWord() gives multiple definition errors.
+ *
+ * The global generator is a RandomX1T<RandomX1Xorshift32> whatever
+ * RANDOMX1_ENGINE is set to.  It can't use RandomX1NativeEngine, the Arduino
+ * default: that would still call the core's random() for every pool refill,
+ * slow and sharing its state with everything else.  Other files that call
+ * randomx1_global() declare it as
+ *
+ *		RandomX1T<RandomX1Xorshift32> &randomx1_global();
+ *
+ * The global generator is created the first time one of these is called, so
+ * it works from the constructors of other global objects.  Use
+ * randomx1_global() to call randomBits() and the other RandomX1 functions
+ * on the same generator.
+ *
+ * Like the originals, random() takes ranges up to the full long range;
+ * ranges wider than RandomX1::MAX_VALUE_PER_RANDOM_REQUEST are built from
+ * two randomBits() requests.  The sequences differ from the originals for
+ * the same seed.
+ *
+ */
+
+//
+// randomx1_global()
+//
+// The generator behind random() and randomSeed()
+//
+RandomX1T<RandomX1Xorshift32> &randomx1_global()
+{
+	static RandomX1T<RandomX1Xorshift32>	rng;
+
+	return rng;
+}
+
+//
+// randomSeed()
+//
+// Re-seeds the global generator.  Like the original, a seed of 0 is ignored.
+//
+void randomSeed(unsigned long seed)
+{
+	if(seed != 0) {
+		randomx1_global().randomSeed(seed);
+	}
+}
+
+//
+// random()
+//
+// Returns a random number between 'howsmall' (inclusive) and 'howbig'
+// (exclusive), or 'howsmall' when 'howbig' <= 'howsmall'
+//
+long random(long howsmall, long howbig)
+{
+	if(howsmall >= howbig) {
+		return howsmall;
+	}
+
+	// The span is at most 2^32 - 1, even for the full long range
+	return (long)((unsigned long)howsmall +
+			_randomx1_below(randomx1_global(), (uint32_t)((unsigned long)howbig - (unsigned long)howsmall)));
+}
+
+//
+// random(), without min value
+//
+long random(long howbig)
+{
+	return random(0, howbig);
+}
+
+#if defined(ARDUINO_ARCH_AVR)
+//
+// map(), makeWord()
+//
+// The rest of the AVR core's WMath.cpp, unchanged
+//
+long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+	return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+unsigned int makeWord(unsigned int w)
+{
+	return w;
+}
+
+unsigned int makeWord(unsigned char h, unsigned char l)
+{
+	return (h << 8) | l;
+}
+#endif
+
+
+#endif
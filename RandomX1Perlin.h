@@ -0,0 +1,368 @@
+///////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef	RANDOM__NUS__X_1__PERLIN__HEADER__FILE__
+#define	RANDOM__NUS__X_1__PERLIN__HEADER__FILE__
+
+#include	"RandomX1.h"
+
+
+/*
+ * RandomX1Perlin is fixed-point Perlin gradient noise in 1, 2 and 3
+ * dimensions (improved Perlin noise: quintic fade, 12 edge gradients).
+ *
+ * The lattice is hashed with a 256-byte permutation that the caller owns.
+ * With PERM_IN_FLASH it is read from flash on AVR, so it can be generated
+ * at compile time (RandomX1Constexpr.h, C++14) and use no RAM:
+ *
+ *		static const RandomX1Table<uint8_t, 256> perm PROGMEM =
+ *				makeShuffleTable<uint8_t, 256>(1234);
+ *
+ *		RandomX1Perlin<true>	noise(perm.values);
+ *
+ * or it is shuffled into RAM at runtime:
+ *
+ *		uint8_t					perm[256];
+ *
+ *		RandomX1Perlin<>::shuffle(rng, perm);
+ *		RandomX1Perlin<>		noise(perm);
+ *
+ * shuffle() draws the same way as makeShuffleTable(), so a freshly seeded
+ * RandomX1 with the default shift layout gives the same table as
+ * makeShuffleTable() with the same seed and engine.
+ *
+ * Coordinates are unsigned fixed point, 16.16 for noise16() and 8.8 for
+ * noise8(); the lattice repeats every 256 units.  noise16() returns about
+ * -32767 to 32767, noise8() 0 to 255 centred on 128.  2D noise is the z = 0
+ * slice of 3D noise; 1D noise has its own gradients so it has no flat
+ * spots.
+ *
+ * Everything is integer arithmetic.  Fractions are kept to 12 bits and the
+ * fade curve to 16, with 32-bit products; noise8() uses the same core, as
+ * the products of the 3D blend don't fit 16 bits.  Corners with a zero
+ * blend weight are skipped, so 2D costs about half of 3D.
+ *
+ * noise16Row() evaluates a whole row of samples along x.  The lattice
+ * corners are hashed and blended once per cell, and the samples within a
+ * cell are then pure arithmetic with no table lookups, which compilers
+ * vectorize on hosts.
+ *
+ */
+template<bool PERM_IN_FLASH = false>
+class RandomX1Perlin
+{
+public:
+	RandomX1Perlin(const uint8_t *perm)
+		: m_perm(perm)
+	{
+	}
+
+	//
+	// shuffle()
+	//
+	// Fills 'perm' with a random permutation of 0 to 255 (Fisher-Yates,
+	// drawing with random(i + 1))
+	//
+	template<class Engine>
+	static void shuffle(RandomX1T<Engine> &rng, uint8_t *perm)
+	{
+		uint8_t		temp, j;
+
+		for(uint16_t i = 0; i < 256; i++) {
+			perm[i] = (uint8_t)i;
+		}
+
+		for(uint16_t i = 255; i > 0; i--) {
+			j = (uint8_t)rng.random(i + 1);
+			temp = perm[i];
+			perm[i] = perm[j];
+			perm[j] = temp;
+		}
+	}
+
+	//
+	// noise16()
+	//
+	// Returns the noise at 16.16 fixed point coordinates
+	//
+	int16_t noise16(uint32_t x) const
+	{
+		uint8_t		xi = (uint8_t)(x >> 16);
+		int32_t		fx = (int32_t)((x >> 4) & 0xfff);
+		int32_t		a, b;
+
+		a = _grad1(this->_perm(xi), fx);
+		b = _grad1(this->_perm((uint8_t)(xi + 1)), fx - ONE);
+
+		return _output(a + (((b - a) * (int32_t)_fade((uint16_t)x)) >> 16), SCALE_1D);
+	}
+
+	int16_t noise16(uint32_t x, uint32_t y) const
+	{
+		return this->noise16(x, y, 0);
+	}
+
+	int16_t noise16(uint32_t x, uint32_t y, uint32_t z) const
+	{
+		_Cell	cell;
+
+		this->_cell((uint8_t)(x >> 16), (uint8_t)(y >> 16), (uint8_t)(z >> 16),
+				(int32_t)((y >> 4) & 0xfff), (int32_t)((z >> 4) & 0xfff),
+				_fade((uint16_t)y), _fade((uint16_t)z), cell);
+
+		return _output(_blend(cell, (int32_t)((x >> 4) & 0xfff), _fade((uint16_t)x)), SCALE_3D);
+	}
+
+	//
+	// noise8()
+	//
+	// Returns the noise at 8.8 fixed point coordinates, 0 to 255
+	//
+	uint8_t noise8(uint16_t x) const
+	{
+		return _to8(this->noise16((uint32_t)x << 8));
+	}
+
+	uint8_t noise8(uint16_t x, uint16_t y) const
+	{
+		return _to8(this->noise16((uint32_t)x << 8, (uint32_t)y << 8, 0));
+	}
+
+	uint8_t noise8(uint16_t x, uint16_t y, uint16_t z) const
+	{
+		return _to8(this->noise16((uint32_t)x << 8, (uint32_t)y << 8, (uint32_t)z << 8));
+	}
+
+	//
+	// noise16Row()
+	//
+	// Writes noise16(x + i * step, y, z) to out[i] for 'count' samples
+	//
+	void noise16Row(int16_t *out, size_t count, uint32_t x, uint32_t step, uint32_t y, uint32_t z = 0) const
+	{
+		_Cell		cell;
+		uint16_t	vy = _fade((uint16_t)y), vz = _fade((uint16_t)z);
+		size_t		run;
+		uint32_t	frac;
+
+		while(count > 0) {
+			this->_cell((uint8_t)(x >> 16), (uint8_t)(y >> 16), (uint8_t)(z >> 16),
+					(int32_t)((y >> 4) & 0xfff), (int32_t)((z >> 4) & 0xfff), vy, vz, cell);
+
+			// Samples left in this cell
+			frac = x & 0xffff;
+			run = (step == 0) ? count : (size_t)((0x10000 - frac + step - 1) / step);
+
+			if(run > count) {
+				run = count;
+			}
+
+			for(size_t i = 0; i < run; i++) {
+				uint32_t	fx = frac + (uint32_t)i * step;
+
+				out[i] = _output(_blend(cell, (int32_t)(fx >> 4), _fade((uint16_t)fx)), SCALE_3D);
+			}
+
+			out += run;
+			count -= run;
+			x += (uint32_t)run * step;
+		}
+	}
+
+private:
+	//
+	// _Cell
+	//
+	// A lattice cell with y and z fixed.  Along x the noise is
+	// A + (B - A) * fade(x), where A and B are linear in x:
+	// A = a0 + a1 * x and B = b0 + b1 * (x - 1), in Q12 (a1 and b1 Q15).
+	//
+	struct _Cell
+	{
+		int32_t		a0, a1, b0, b1;
+	};
+
+	//
+	// _perm()
+	//
+	inline uint8_t _perm(uint8_t index) const
+	{
+		return PERM_IN_FLASH ? RANDOMX1_READ_BYTE(&m_perm[index]) : m_perm[index];
+	}
+
+	//
+	// _fade()
+	//
+	// 6t^5 - 15t^4 + 10t^3, Q16 in and out
+	//
+	static inline uint16_t _fade(uint16_t t)
+	{
+		uint32_t	t2 = ((uint32_t)t * t) >> 16;
+		uint32_t	t3 = (t2 * t) >> 16;
+		// 6t^2 - 15t + 10 is always positive
+		uint32_t	p = 6 * t2 + 10 * 65536UL - 15 * (uint32_t)t;
+
+		return (uint16_t)((t3 * p) >> 16);
+	}
+
+	//
+	// _grad1()
+	//
+	// 1D gradient 1 to 8 with a random sign, times 'd' / 8
+	//
+	static inline int32_t _grad1(uint8_t hash, int32_t d)
+	{
+		int32_t		res = ((int32_t)(hash & 0x07) + 1) * d / 8;
+
+		return (hash & 0x08) ? -res : res;
+	}
+
+	//
+	// _grad3()
+	//
+	// The 12 edge gradients of improved Perlin noise (4 of them twice),
+	// as -1, 0 or 1 per axis
+	//
+	static inline void _grad3(uint8_t hash, int8_t &gx, int8_t &gy, int8_t &gz)
+	{
+		uint8_t		h = hash & 0x0f;
+		int8_t		su = (h & 0x01) ? -1 : 1;
+		int8_t		sv = (h & 0x02) ? -1 : 1;
+
+		gx = gy = gz = 0;
+
+		// u is x or y
+		if(h < 8) {
+			gx = su;
+		}
+		else {
+			gy = su;
+		}
+
+		// v is y, x or z
+		if(h < 4) {
+			gy = sv;
+		}
+		else if(h == 12 || h == 14) {
+			gx = sv;
+		}
+		else {
+			gz = sv;
+		}
+	}
+
+	//
+	// _cell()
+	//
+	// Hashes the corners of cell (xi, yi, zi) and blends them in y and z
+	//
+	void _cell(uint8_t xi, uint8_t yi, uint8_t zi, int32_t fy, int32_t fz,
+			uint16_t vy, uint16_t vz, _Cell &cell) const
+	{
+		uint8_t		px0 = this->_perm(xi), px1 = this->_perm((uint8_t)(xi + 1));
+		uint8_t		h0, h1, pxy0, pxy1;
+		int8_t		gx, gy, gz;
+		int32_t		wy, wz, weight, dy, dz;
+
+		cell.a0 = cell.a1 = cell.b0 = cell.b1 = 0;
+
+		for(uint8_t j = 0; j < 2; j++) {
+			// Q15 weights, the complement can be 32768
+			wy = j ? (vy >> 1) : (32768 - (vy >> 1));
+			dy = j ? (fy - ONE) : fy;
+
+			pxy0 = this->_perm((uint8_t)(px0 + yi + j));
+			pxy1 = this->_perm((uint8_t)(px1 + yi + j));
+
+			for(uint8_t k = 0; k < 2; k++) {
+				wz = k ? (vz >> 1) : (32768 - (vz >> 1));
+				weight = (wy * wz) >> 15;
+
+				if(weight == 0) {
+					continue;
+				}
+
+				dz = k ? (fz - ONE) : fz;
+
+				h0 = this->_perm((uint8_t)(pxy0 + zi + k));
+				h1 = this->_perm((uint8_t)(pxy1 + zi + k));
+
+				_grad3(h0, gx, gy, gz);
+				cell.a1 += weight * gx;
+				cell.a0 += weight * (gy * dy + gz * dz);
+
+				_grad3(h1, gx, gy, gz);
+				cell.b1 += weight * gx;
+				cell.b0 += weight * (gy * dy + gz * dz);
+			}
+		}
+
+		cell.a0 >>= 15;
+		cell.b0 >>= 15;
+	}
+
+	//
+	// _blend()
+	//
+	// Noise at Q12 offset 'fx' into the cell, Q12
+	//
+	static inline int32_t _blend(const _Cell &cell, int32_t fx, uint16_t u)
+	{
+		int32_t		a = cell.a0 + ((cell.a1 * fx) >> 15);
+		int32_t		b = cell.b0 + ((cell.b1 * (fx - ONE)) >> 15);
+
+		return a + (((b - a) * (int32_t)u) >> 16);
+	}
+
+	//
+	// _output()
+	//
+	// Scales a Q12 noise value to int16_t
+	//
+	static inline int16_t _output(int32_t value, int32_t scale)
+	{
+		value = (value * scale) >> 4;
+
+		if(value > INT16_MAX) {
+			return INT16_MAX;
+		}
+		else if(value < -INT16_MAX) {
+			return -INT16_MAX;
+		}
+
+		return (int16_t)value;
+	}
+
+	//
+	// _to8()
+	//
+	static inline uint8_t _to8(int16_t value)
+	{
+		return (uint8_t)((value >> 8) + 128);
+	}
+
+private:
+	// 1.0 in the Q12 offsets
+	static const int32_t	ONE = 4096;
+
+	// Output scale in 1/16ths, from Q12 to about the full int16_t range
+	static const int32_t	SCALE_1D = 256;
+	static const int32_t	SCALE_3D = 128;
+
+	const uint8_t	*m_perm;
+};
+
+
+#endif
@@ -0,0 +1,421 @@
+///////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef	RANDOM__NUS__X_1__QUASI__HEADER__FILE__
+#define	RANDOM__NUS__X_1__QUASI__HEADER__FILE__
+
+#include	"RandomX1.h"
+
+
+/*
+ * Low-discrepancy (quasi-random) sequences.  Successive values spread out
+ * evenly instead of clumping, so averages over them converge with far fewer
+ * samples than with random values (error about 1/n instead of 1/sqrt(n)),
+ * and small sets of positions cover a strip or matrix evenly.  They are not
+ * random: don't use them where values must be unpredictable or independent.
+ *
+ *		RandomX1R1		1D additive recurrence, golden ratio step
+ *		RandomX1R2		2D additive recurrence, plastic number steps
+ *		RandomX1Sobol	Sobol points in up to 10 dimensions, scrambled
+ *						(host only, not AVR)
+ *
+ * R1 and R2 are one 32-bit addition per coordinate, cheap enough for AVR.
+ * All of them can be given a random offset or scramble from a RandomX1, so
+ * that different runs get different, equally even sequences.
+ *
+ * RandomX1R1 has the RandomX1 interface, every randomBits() or random()
+ * call advances it.  RandomX1R2 and RandomX1Sobol produce points: next()
+ * advances to the next point and randomBits() / random() take the
+ * dimension as their first argument.
+ *
+ * randomBits() and random() have the same limits as in RandomX1.  random()
+ * scales the value into the range instead of rejecting values, which would
+ * break up the even spacing.
+ *
+ */
+
+//
+// _randomx1_quasi_bits()
+//
+// The top 'bit_count' bits of 'value', with the RandomX1::randomBits()
+// limits
+//
+static inline long _randomx1_quasi_bits(uint32_t value, uint8_t bit_count)
+{
+	if(bit_count == 0) {
+		return 0;
+	}
+
+	if(bit_count > RandomX1::MAX_BITS_PER_RANDOM_REQUEST) {
+		bit_count = RandomX1::MAX_BITS_PER_RANDOM_REQUEST;
+	}
+
+	return (long)(value >> (32 - bit_count));
+}
+
+//
+// _randomx1_quasi_range()
+//
+// Scales 'value' (a fraction of 2^32) into 'min_val' (inclusive) to
+// 'max_val' (exclusive), with the RandomX1::random() limits
+//
+static inline long _randomx1_quasi_range(uint32_t value, long min_val, long max_val)
+{
+	long		count = max_val - min_val;
+
+	if(count <= 1) {
+		return min_val;
+	}
+
+	if(count > RandomX1::MAX_VALUE_PER_RANDOM_REQUEST + 1) {
+		count = RandomX1::MAX_VALUE_PER_RANDOM_REQUEST + 1;
+	}
+
+	// A 16x16-bit multiply is enough for ranges up to 65536
+	if(count <= 0x10000) {
+		return min_val + (long)(((value >> 16) * (uint32_t)count) >> 16);
+	}
+
+	return min_val + (long)(((uint64_t)value * (uint32_t)count) >> 32);
+}
+
+//
+// RandomX1R1
+//
+// x(n) = frac(x(0) + n / phi)
+//
+class RandomX1R1
+{
+public:
+	//
+	// Constructors, start at 1/2 or at a random offset
+	//
+	RandomX1R1()
+		: m_value(0x80000000)
+	{
+	}
+
+	RandomX1R1(RandomX1 &rng)
+		: m_value(((uint32_t)rng.randomBits16(16) << 16) | rng.randomBits16(16))
+	{
+	}
+
+	//
+	// randomBits(), see RandomX1::randomBits()
+	//
+	inline long randomBits(uint8_t bit_count)
+	{
+		return _randomx1_quasi_bits(this->_next(), bit_count);
+	}
+
+	//
+	// random(), see RandomX1::random()
+	//
+	inline long random(long min_val, long max_val)
+	{
+		return _randomx1_quasi_range(this->_next(), min_val, max_val);
+	}
+
+	inline long random(long max_val)
+	{
+		return this->random(0, max_val);
+	}
+
+private:
+	inline uint32_t _next()
+	{
+		m_value += ALPHA;
+		return m_value;
+	}
+
+private:
+	// 2^32 / phi
+	static const uint32_t	ALPHA = 0x9e3779b9;
+
+	uint32_t		m_value;
+};
+
+//
+// RandomX1R2
+//
+// (x, y)(n) = frac((x, y)(0) + n * (1 / g, 1 / g^2)), g the plastic number
+//
+class RandomX1R2
+{
+public:
+	//
+	// Constructors, start at (1/2, 1/2) or at a random offset
+	//
+	RandomX1R2()
+	{
+		m_values[0] = m_values[1] = 0x80000000;
+	}
+
+	RandomX1R2(RandomX1 &rng)
+	{
+		for(uint8_t i = 0; i < 2; i++) {
+			m_values[i] = ((uint32_t)rng.randomBits16(16) << 16) | rng.randomBits16(16);
+		}
+	}
+
+	//
+	// next()
+	//
+	// Advance to the next point
+	//
+	inline void next()
+	{
+		m_values[0] += ALPHA_X;
+		m_values[1] += ALPHA_Y;
+	}
+
+	//
+	// randomBits(), random()
+	//
+	// Coordinate 'dim' (0 for x, 1 for y) of the current point, see
+	// RandomX1::randomBits() and RandomX1::random()
+	//
+	inline long randomBits(uint8_t dim, uint8_t bit_count) const
+	{
+		return _randomx1_quasi_bits(m_values[dim & 0x01], bit_count);
+	}
+
+	inline long random(uint8_t dim, long min_val, long max_val) const
+	{
+		return _randomx1_quasi_range(m_values[dim & 0x01], min_val, max_val);
+	}
+
+private:
+	// 2^32 / g and 2^32 / g^2
+	static const uint32_t	ALPHA_X = 0xc13fa9a9;
+	static const uint32_t	ALPHA_Y = 0x91e10da6;
+
+	uint32_t		m_values[2];
+};
+
+#if !defined(__AVR__)
+//
+// RandomX1Sobol
+//
+// Sobol points in up to MAX_DIMS dimensions (Joe and Kuo direction
+// numbers).  With a RandomX1 every dimension gets its own nested uniform
+// (Owen-style) scramble, using the Laine-Karras hash on the bit-reversed
+// value, which keeps the stratification of the points.  The point index is
+// scrambled the same way, so every prefix of the sequence is still
+// well-spread and seeds don't share their first point.
+//
+// The first 2^m points put exactly one point in each of the 2^m equal
+// intervals of every dimension.  Use power-of-2 sample counts for the
+// best results.
+//
+class RandomX1Sobol
+{
+public:
+	static const uint8_t	MAX_DIMS = 10;
+
+	//
+	// Constructors, unscrambled or scrambled from 'rng'
+	//
+	RandomX1Sobol(uint8_t dims = 2)
+	{
+		this->_init(dims);
+	}
+
+	RandomX1Sobol(RandomX1 &rng, uint8_t dims = 2)
+	{
+		this->_init(dims);
+		m_scrambled = true;
+
+		for(uint8_t d = 0; d < m_dims; d++) {
+			m_seeds[d] = ((uint32_t)rng.randomBits16(16) << 16) | rng.randomBits16(16);
+		}
+
+		m_seeds[MAX_DIMS] = ((uint32_t)rng.randomBits16(16) << 16) | rng.randomBits16(16);
+
+		this->_update();
+	}
+
+	//
+	// next()
+	//
+	// Advance to the next point.  The first point is available without
+	// calling next().
+	//
+	inline void next()
+	{
+		m_index++;
+		this->_update();
+	}
+
+	//
+	// randomBits(), random()
+	//
+	// Coordinate 'dim' of the current point, see RandomX1::randomBits() and
+	// RandomX1::random()
+	//
+	inline long randomBits(uint8_t dim, uint8_t bit_count) const
+	{
+		return _randomx1_quasi_bits(m_values[dim % m_dims], bit_count);
+	}
+
+	inline long random(uint8_t dim, long min_val, long max_val) const
+	{
+		return _randomx1_quasi_range(m_values[dim % m_dims], min_val, max_val);
+	}
+
+	//
+	// uniform()
+	//
+	// Coordinate 'dim' of the current point as a double in [0, 1), for
+	// Monte Carlo integration
+	//
+	inline double uniform(uint8_t dim) const
+	{
+		return m_values[dim % m_dims] * (1.0 / 4294967296.0);
+	}
+
+private:
+	//
+	// _init()
+	//
+	// Builds the direction numbers of the first 'dims' dimensions
+	//
+	void _init(uint8_t dims)
+	{
+		// Degree, coefficients and initial direction numbers of the
+		// primitive polynomials for dimensions 2 to 10 (new-joe-kuo-6.21201)
+		static const uint8_t	DEGREES[MAX_DIMS - 1] = { 1, 2, 3, 3, 4, 4, 5, 5, 5 };
+		static const uint8_t	COEFFS[MAX_DIMS - 1] = { 0, 1, 1, 2, 1, 4, 2, 4, 7 };
+		static const uint8_t	INITIAL[MAX_DIMS - 1][5] = {
+			{ 1 },
+			{ 1, 3 },
+			{ 1, 3, 1 },
+			{ 1, 1, 1 },
+			{ 1, 1, 3, 3 },
+			{ 1, 3, 5, 13 },
+			{ 1, 1, 5, 5, 17 },
+			{ 1, 1, 5, 5, 5 },
+			{ 1, 1, 7, 11, 19 }
+		};
+		uint8_t		s, a;
+
+		m_dims = (dims == 0) ? 1 : ((dims > MAX_DIMS) ? MAX_DIMS : dims);
+		m_index = 0;
+		m_scrambled = false;
+
+		for(uint8_t d = 0; d <= MAX_DIMS; d++) {
+			m_seeds[d] = 0;
+		}
+
+		// First dimension, van der Corput
+		for(uint8_t i = 0; i < 32; i++) {
+			m_directions[0][i] = (uint32_t)1 << (31 - i);
+		}
+
+		for(uint8_t d = 1; d < m_dims; d++) {
+			s = DEGREES[d - 1];
+			a = COEFFS[d - 1];
+
+			for(uint8_t i = 0; i < s; i++) {
+				m_directions[d][i] = (uint32_t)INITIAL[d - 1][i] << (31 - i);
+			}
+
+			for(uint8_t i = s; i < 32; i++) {
+				m_directions[d][i] = m_directions[d][i - s] ^ (m_directions[d][i - s] >> s);
+
+				for(uint8_t k = 1; k < s; k++) {
+					if((a >> (s - 1 - k)) & 0x01) {
+						m_directions[d][i] ^= m_directions[d][i - k];
+					}
+				}
+			}
+		}
+
+		this->_update();
+	}
+
+	//
+	// _update()
+	//
+	// Computes the coordinates of point 'm_index'
+	//
+	void _update()
+	{
+		uint32_t	index = m_index;
+		uint32_t	value;
+
+		// Scrambling the index shuffles the order of the points
+		if(m_scrambled) {
+			index = _nested_scramble(index, m_seeds[MAX_DIMS]);
+		}
+
+		for(uint8_t d = 0; d < m_dims; d++) {
+			value = 0;
+
+			for(uint8_t i = 0; i < 32 && (index >> i) != 0; i++) {
+				if((index >> i) & 0x01) {
+					value ^= m_directions[d][i];
+				}
+			}
+
+			m_values[d] = m_scrambled ? _nested_scramble(value, m_seeds[d]) : value;
+		}
+	}
+
+	//
+	// _reverse_bits()
+	//
+	static inline uint32_t _reverse_bits(uint32_t value)
+	{
+		value = ((value >> 1) & 0x55555555) | ((value & 0x55555555) << 1);
+		value = ((value >> 2) & 0x33333333) | ((value & 0x33333333) << 2);
+		value = ((value >> 4) & 0x0f0f0f0f) | ((value & 0x0f0f0f0f) << 4);
+		value = ((value >> 8) & 0x00ff00ff) | ((value & 0x00ff00ff) << 8);
+		return (value >> 16) | (value << 16);
+	}
+
+	//
+	// _nested_scramble()
+	//
+	// Nested uniform scramble: each bit is flipped depending only on the
+	// bits above it.  The Laine-Karras hash has that property for the
+	// bits below, so it is applied to the bit-reversed value.
+	//
+	static inline uint32_t _nested_scramble(uint32_t value, uint32_t seed)
+	{
+		value = _reverse_bits(value);
+
+		value += seed;
+		value ^= value * 0x6c50b47c;
+		value ^= value * 0xb82f1e52;
+		value ^= value * 0xc7afe638;
+		value ^= value * 0x8d22f6e6;
+
+		return _reverse_bits(value);
+	}
+
+private:
+	uint8_t			m_dims;
+	bool			m_scrambled;
+	uint32_t		m_index;
+	// One seed per dimension, then the index seed
+	uint32_t		m_seeds[MAX_DIMS + 1];
+	uint32_t		m_directions[MAX_DIMS][32];
+	uint32_t		m_values[MAX_DIMS];
+};
+#endif
+
+
+#endif
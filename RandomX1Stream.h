@@ -0,0 +1,250 @@
+///////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef	RANDOM__NUS__X_1__STREAM__HEADER__FILE__
+#define	RANDOM__NUS__X_1__STREAM__HEADER__FILE__
+
+#include	<string.h>
+
+#include	"RandomX1.h"
+
+#if !defined(ARDUINO)
+#include	<errno.h>
+#include	<unistd.h>
+#endif
+
+//
+// Size of the internal block buffer, in bytes.  Small on Arduino to save
+// RAM, a page on the host so write() system calls don't dominate.
+//
+#ifndef	RANDOMX1_STREAM_BLOCK_BYTES
+#if defined(ARDUINO)
+#define	RANDOMX1_STREAM_BLOCK_BYTES		32
+#else
+#define	RANDOMX1_STREAM_BLOCK_BYTES		4096
+#endif
+#endif
+
+
+/*
+ * RandomX1Stream is an endless source of random bytes.
+ *
+ * On Arduino it is a Stream, so it can be read like Serial, and writeTo()
+ * sends random bytes to any Print (Serial, an SPI or Wire wrapper, ...) a
+ * whole block at a time through write(const uint8_t *, size_t).  On the host
+ * writeTo() takes a POSIX file descriptor instead.
+ *
+ * The bytes come from RandomX1::randomBytes() into a block buffer inside the
+ * object; nothing is allocated.  The RandomX1 passed to the constructor must
+ * outlive the stream.
+ *
+ */
+class RandomX1Stream
+#if defined(ARDUINO)
+	: public Stream
+#endif
+{
+public:
+	RandomX1Stream(RandomX1 &rng)
+		: m_rng(rng)
+	{
+		m_blockIndex = RANDOMX1_STREAM_BLOCK_BYTES;
+	}
+
+	virtual ~RandomX1Stream()
+	{
+	}
+
+	//
+	// available()
+	//
+	// There is always more data, returns the largest count an int can hold.
+	//
+	virtual int available()
+	{
+		return INT_MAX;
+	}
+
+	//
+	// read()
+	//
+	// Returns the next random byte
+	//
+	virtual int read()
+	{
+		if(m_blockIndex == RANDOMX1_STREAM_BLOCK_BYTES) {
+			this->_refill();
+		}
+
+		return m_block[m_blockIndex++];
+	}
+
+	//
+	// peek()
+	//
+	// Returns the byte the next read() will return
+	//
+	virtual int peek()
+	{
+		if(m_blockIndex == RANDOMX1_STREAM_BLOCK_BYTES) {
+			this->_refill();
+		}
+
+		return m_block[m_blockIndex];
+	}
+
+	//
+	// readBytes()
+	//
+	// Fills 'buffer' with 'length' random bytes.  Bytes left in the block
+	// are used first, the rest is generated straight into 'buffer'.
+	//
+	size_t readBytes(uint8_t *buffer, size_t length)
+	{
+		size_t		count = RANDOMX1_STREAM_BLOCK_BYTES - m_blockIndex;
+
+		if(count > length) {
+			count = length;
+		}
+
+		memcpy(buffer, &m_block[m_blockIndex], count);
+		m_blockIndex += count;
+
+		m_rng.randomBytes(buffer + count, length - count);
+		return length;
+	}
+
+	size_t readBytes(char *buffer, size_t length)
+	{
+		return this->readBytes((uint8_t *)buffer, length);
+	}
+
+#if defined(ARDUINO)
+	//
+	// write()
+	//
+	// The stream is read-only, nothing is written.
+	//
+	virtual size_t write(uint8_t)
+	{
+		return 0;
+	}
+
+	using Print::write;
+
+	virtual void flush()
+	{
+	}
+
+	//
+	// writeTo()
+	//
+	// Writes 'count' random bytes to 'out', one block per write() call.
+	// Returns the number of bytes written, which is less than 'count' if
+	// 'out' stops accepting data.
+	//
+	size_t writeTo(Print &out, size_t count)
+	{
+		size_t		total = 0;
+		size_t		length, written;
+
+		while(count > 0) {
+			length = this->_next_block(count);
+			written = out.write(&m_block[m_blockIndex], length);
+			m_blockIndex += written;
+			total += written;
+
+			if(written < length) {
+				break;
+			}
+
+			count -= written;
+		}
+
+		return total;
+	}
+#else
+	//
+	// writeTo()
+	//
+	// Writes 'count' random bytes to file descriptor 'fd', one block per
+	// write() call.  Returns the number of bytes written, which is less than
+	// 'count' if write() fails or returns 0, or -1 if nothing was written
+	// and write() failed (errno is set).
+	//
+	ssize_t writeTo(int fd, size_t count)
+	{
+		size_t		total = 0;
+		size_t		length;
+		ssize_t		written;
+
+		while(count > 0) {
+			length = this->_next_block(count);
+			written = ::write(fd, &m_block[m_blockIndex], length);
+
+			if(written <= 0) {
+				if(written < 0 && errno == EINTR) {
+					continue;
+				}
+
+				// A write() of 0 makes no progress, stop as on an error
+				return (total > 0 || written == 0) ? (ssize_t)total : -1;
+			}
+
+			m_blockIndex += written;
+			total += written;
+			count -= written;
+		}
+
+		return total;
+	}
+#endif
+
+private:
+	//
+	// _refill()
+	//
+	inline void _refill()
+	{
+		m_rng.randomBytes(m_block, RANDOMX1_STREAM_BLOCK_BYTES);
+		m_blockIndex = 0;
+	}
+
+	//
+	// _next_block()
+	//
+	// Returns how many bytes of the block, at most 'count', can be written
+	// next, refilling the block if it's used up.
+	//
+	inline size_t _next_block(size_t count)
+	{
+		size_t		length;
+
+		if(m_blockIndex == RANDOMX1_STREAM_BLOCK_BYTES) {
+			this->_refill();
+		}
+
+		length = RANDOMX1_STREAM_BLOCK_BYTES - m_blockIndex;
+		return (count < length) ? count : length;
+	}
+
+private:
+	RandomX1		&m_rng;
+	uint8_t			m_block[RANDOMX1_STREAM_BLOCK_BYTES];
+	size_t			m_blockIndex;
+};
+
+
+#endif
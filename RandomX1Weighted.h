@@ -0,0 +1,556 @@
+///////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef	RANDOM__NUS__X_1__WEIGHTED__HEADER__FILE__
+#define	RANDOM__NUS__X_1__WEIGHTED__HEADER__FILE__
+
+#include	<math.h>
+
+#include	"RandomX1.h"
+
+#if !defined(__AVR__)
+#include	<vector>
+#endif
+
+
+/*
+ * RandomX1WeightedSampler picks item 'i' with probability
+ * weight(i) / total(), for weights that change between picks:
+ *
+ *		RandomX1WeightedSampler<8>	tasks(rng);
+ *
+ *		tasks.update(TASK_LED, 10);
+ *		tasks.update(TASK_RADIO, 3);
+ *		...
+ *		run(tasks.sample());
+ *
+ * The weights are kept in a Fenwick (binary indexed) tree, so update() and
+ * sample() are both O(log n): sample() is one draw below total() and a
+ * descent of the tree, with no cumulative sums to rebuild.  The tree is the
+ * only storage, one uint32_t per item; single weights are read back from it
+ * in O(log n) as well.
+ *
+ * With 'N' > 0 the capacity is fixed at 'N' items, in the object.  On the
+ * host 'N' = 0 (the default) gives a sampler that grows with resize() and
+ * push().
+ *
+ * Weights are uint32_t and total() must stay below 2^32.  The RandomX1
+ * passed to the constructor must outlive the sampler.
+ *
+ * RandomX1WeightedReservoir keeps a weighted random sample of 'K' items
+ * from a stream of any length, e.g. log lines seen by a gateway:
+ *
+ *		RandomX1WeightedReservoir<LogLine, 16>	sample(rng);
+ *
+ *		sample.offer(line, line.severity);
+ *		...
+ *		for(size_t i = 0; i < sample.size(); i++) {
+ *			send(sample.item(i));
+ *		}
+ *
+ */
+
+//
+// _RandomX1WeightedStorage
+//
+// The Fenwick tree, 1-based: tree[i] holds the sum of the weights of items
+// (i - lowbit(i), i]
+//
+template<size_t N>
+struct _RandomX1WeightedStorage
+{
+	uint32_t	tree[N + 1];
+
+	inline uint32_t *data()
+	{
+		return tree;
+	}
+
+	inline const uint32_t *data() const
+	{
+		return tree;
+	}
+
+	static inline size_t capacity()
+	{
+		return N;
+	}
+
+	static inline void reserve(size_t)
+	{
+	}
+};
+
+#if !defined(__AVR__)
+template<>
+struct _RandomX1WeightedStorage<0>
+{
+	std::vector<uint32_t>	tree;
+
+	_RandomX1WeightedStorage()
+		: tree(1, 0)
+	{
+	}
+
+	inline uint32_t *data()
+	{
+		return &tree[0];
+	}
+
+	inline const uint32_t *data() const
+	{
+		return &tree[0];
+	}
+
+	inline size_t capacity() const
+	{
+		return tree.max_size() - 1;
+	}
+
+	inline void reserve(size_t count)
+	{
+		if(tree.size() < count + 1) {
+			tree.resize(count + 1, 0);
+		}
+	}
+};
+#endif
+
+#if defined(__AVR__)
+template<size_t N>
+#else
+template<size_t N = 0>
+#endif
+class RandomX1WeightedSampler
+{
+public:
+	//
+	// Constructor, 'count' items of weight 0
+	//
+	RandomX1WeightedSampler(RandomX1 &rng, size_t count = N)
+		: m_rng(rng), m_count(0), m_total(0)
+	{
+		this->resize(count);
+	}
+
+	//
+	// size(), total()
+	//
+	inline size_t size() const
+	{
+		return m_count;
+	}
+
+	inline uint32_t total() const
+	{
+		return m_total;
+	}
+
+	//
+	// resize()
+	//
+	// Sets the number of items.  New items have weight 0, the weights of
+	// the items kept don't change.  'count' is limited to the capacity.
+	//
+	void resize(size_t count)
+	{
+		uint32_t	*tree;
+
+		if(count > m_storage.capacity()) {
+			count = m_storage.capacity();
+		}
+
+		m_storage.reserve(count);
+		tree = m_storage.data();
+
+		// A new node covers kept items only, the rest of its range is 0
+		for(size_t i = m_count + 1; i <= count; i++) {
+			tree[i] = this->_prefix(i - 1) - this->_prefix(i - _lowbit(i));
+		}
+
+		m_count = count;
+		m_total = this->_prefix(count);
+	}
+
+	//
+	// push()
+	//
+	// Adds an item with weight 'weight', returns its index or size() when
+	// the sampler is full
+	//
+	size_t push(uint32_t weight)
+	{
+		size_t		index = m_count;
+
+		this->resize(m_count + 1);
+
+		if(index < m_count) {
+			this->update(index, weight);
+		}
+
+		return index;
+	}
+
+	//
+	// assign()
+	//
+	// Replaces all items with the 'count' weights of 'weights', in O(n)
+	//
+	void assign(const uint32_t *weights, size_t count)
+	{
+		uint32_t	*tree;
+		size_t		parent;
+
+		if(count > m_storage.capacity()) {
+			count = m_storage.capacity();
+		}
+
+		m_storage.reserve(count);
+		tree = m_storage.data();
+
+		for(size_t i = 1; i <= count; i++) {
+			tree[i] = weights[i - 1];
+		}
+
+		// Every node adds itself to the next node covering it
+		for(size_t i = 1; i <= count; i++) {
+			parent = i + _lowbit(i);
+
+			if(parent <= count) {
+				tree[parent] += tree[i];
+			}
+		}
+
+		m_count = count;
+		m_total = this->_prefix(count);
+	}
+
+	//
+	// update()
+	//
+	// Sets the weight of item 'index'.  0 takes it out of the draw.
+	//
+	void update(size_t index, uint32_t weight)
+	{
+		if(index >= m_count) {
+			return;
+		}
+
+		// Unsigned wrap-around makes this work for decreases too
+		this->_add(index + 1, weight - this->weight(index));
+	}
+
+	//
+	// weight()
+	//
+	// Returns the weight of item 'index'
+	//
+	uint32_t weight(size_t index) const
+	{
+		const uint32_t	*tree = m_storage.data();
+		size_t			i = index + 1;
+		size_t			stop = i - _lowbit(i);
+		uint32_t		res;
+
+		if(index >= m_count) {
+			return 0;
+		}
+
+		// tree[i] less the nodes below it, which cover (stop, i - 1]
+		res = tree[i];
+
+		for(size_t j = i - 1; j > stop; j -= _lowbit(j)) {
+			res -= tree[j];
+		}
+
+		return res;
+	}
+
+	//
+	// sample()
+	//
+	// Returns the index of a random item, picked with probability
+	// weight(i) / total(), or size() when total() is 0
+	//
+	size_t sample()
+	{
+		const uint32_t	*tree = m_storage.data();
+		uint32_t		r;
+		size_t			pos = 0, step = 1;
+
+		if(m_total == 0) {
+			return m_count;
+		}
+
+		r = _randomx1_below(m_rng, m_total);
+
+		while(step <= m_count / 2) {
+			step <<= 1;
+		}
+
+		// Finds the first item whose prefix sum is above 'r'
+		for(; step != 0; step >>= 1) {
+			if(pos + step <= m_count && tree[pos + step] <= r) {
+				pos += step;
+				r -= tree[pos];
+			}
+		}
+
+		return pos;
+	}
+
+private:
+	static inline size_t _lowbit(size_t i)
+	{
+		return i & (~i + 1);
+	}
+
+	//
+	// _prefix()
+	//
+	// Sum of the weights of the first 'count' items
+	//
+	uint32_t _prefix(size_t count) const
+	{
+		const uint32_t	*tree = m_storage.data();
+		uint32_t		res = 0;
+
+		for(; count != 0; count -= _lowbit(count)) {
+			res += tree[count];
+		}
+
+		return res;
+	}
+
+	//
+	// _add()
+	//
+	// Adds 'delta' to 1-based item 'i'
+	//
+	void _add(size_t i, uint32_t delta)
+	{
+		uint32_t	*tree = m_storage.data();
+
+		m_total += delta;
+
+		for(; i <= m_count; i += _lowbit(i)) {
+			tree[i] += delta;
+		}
+	}
+
+private:
+	RandomX1						&m_rng;
+	_RandomX1WeightedStorage<N>		m_storage;
+	size_t							m_count;
+	uint32_t						m_total;
+};
+
+
+//
+// RandomX1WeightedReservoir
+//
+// A-ExpJ (Efraimidis and Spirakis): every item gets the key u^(1/w), and
+// the sample is the 'K' items with the largest keys.  Instead of drawing a
+// key per item, the weight to skip before the next item enters the sample
+// is drawn from the smallest key kept, so random numbers are only drawn
+// for items that replace one, about K * ln(n / K) of them for n items.
+//
+// Keys are kept as ln(u) / w, which doesn't underflow for large weights, in
+// a min-heap of 'K' entries inside the object; nothing is allocated.  Items
+// are copied in, so 'T' should be small or a handle.  Items with a weight
+// of 0 or less are never taken.
+//
+template<class T, size_t K>
+class RandomX1WeightedReservoir
+{
+public:
+	RandomX1WeightedReservoir(RandomX1 &rng)
+		: m_rng(rng)
+	{
+		this->clear();
+	}
+
+	//
+	// clear()
+	//
+	// Empties the sample, to start a new stream
+	//
+	void clear()
+	{
+		m_count = 0;
+		m_skip = 0;
+	}
+
+	//
+	// size()
+	//
+	// Number of items in the sample, 'K' once 'K' items have been offered
+	//
+	inline size_t size() const
+	{
+		return m_count;
+	}
+
+	//
+	// item()
+	//
+	// Item 'index' of the sample, in no particular order
+	//
+	inline const T &item(size_t index) const
+	{
+		return m_heap[index].item;
+	}
+
+	//
+	// offer()
+	//
+	// Offers the next item of the stream, returns true when it was taken
+	// into the sample
+	//
+	bool offer(const T &item, double weight)
+	{
+		double		threshold;
+
+		if(!(weight > 0)) {
+			return false;
+		}
+
+		if(m_count < K) {
+			m_heap[m_count].item = item;
+			m_heap[m_count].key = log(this->_uniform()) / weight;
+			this->_sift_up(m_count++);
+
+			if(m_count == K) {
+				this->_draw_skip();
+			}
+
+			return true;
+		}
+
+		m_skip -= weight;
+
+		if(m_skip > 0) {
+			return false;
+		}
+
+		// The new key is u^(1/w) for u drawn above threshold^w, so it beats
+		// the smallest key
+		threshold = exp(m_heap[0].key * weight);
+
+		m_heap[0].item = item;
+		m_heap[0].key = log(threshold + (1.0 - threshold) * this->_uniform()) / weight;
+		this->_sift_down(0);
+
+		this->_draw_skip();
+		return true;
+	}
+
+private:
+	struct _Entry
+	{
+		double		key;
+		T			item;
+	};
+
+	//
+	// _uniform()
+	//
+	// Returns a uniform value in (0, 1)
+	//
+	inline double _uniform()
+	{
+		uint32_t	r = ((uint32_t)m_rng.randomBits16(16) << 16) | m_rng.randomBits16(16);
+
+		return ldexp((double)r + 0.5, -32);
+	}
+
+	//
+	// _draw_skip()
+	//
+	// Weight to pass before the next item is taken: ln(u) / ln(smallest key)
+	//
+	void _draw_skip()
+	{
+		// A smallest key of 1 can't be beaten
+		if(m_heap[0].key < 0) {
+			m_skip = log(this->_uniform()) / m_heap[0].key;
+		}
+		else {
+			m_skip = HUGE_VAL;
+		}
+	}
+
+	void _sift_up(size_t i)
+	{
+		_Entry		temp;
+		size_t		parent;
+
+		// A single entry is always in place, and indexing a parent of the
+		// one-element array gives -Warray-bounds
+		if(K == 1) {
+			return;
+		}
+
+		while(i > 0) {
+			parent = (i - 1) / 2;
+
+			if(!(m_heap[i].key < m_heap[parent].key)) {
+				break;
+			}
+
+			temp = m_heap[i];
+			m_heap[i] = m_heap[parent];
+			m_heap[parent] = temp;
+			i = parent;
+		}
+	}
+
+	void _sift_down(size_t i)
+	{
+		_Entry		temp;
+		size_t		child;
+
+		if(K == 1) {
+			return;
+		}
+
+		while((child = 2 * i + 1) < m_count) {
+			if(child + 1 < m_count && m_heap[child + 1].key < m_heap[child].key) {
+				child++;
+			}
+
+			if(!(m_heap[child].key < m_heap[i].key)) {
+				break;
+			}
+
+			temp = m_heap[i];
+			m_heap[i] = m_heap[child];
+			m_heap[child] = temp;
+			i = child;
+		}
+	}
+
+private:
+	static_assert(K > 0, "RandomX1WeightedReservoir needs K > 0");
+
+	RandomX1		&m_rng;
+	_Entry			m_heap[K];
+	size_t			m_count;
+	// Weight left to pass before the next item is taken
+	double			m_skip;
+};
+
+
+#endif
@@ -0,0 +1,424 @@
+///////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+/*
+ * randomx1_gen, host tool that writes large random files with RandomX1.
+ *
+ * The output file is sized up front and memory-mapped, then split into
+ * chunks of CHUNK_BYTES.  Each chunk gets its own RandomX1, seeded from the
+ * seed and the chunk index, and the threads take whole chunks and write
+ * straight into the mapping.  The output only depends on the seed, the
+ * size and the mode, never on the thread count, so fixtures can be
+ * regenerated on any machine.  The time taken and GB/s are reported on
+ * stderr, so the tool doubles as a throughput benchmark for randomBytes(),
+ * randomBits() and random().
+ *
+ * Modes:
+ *		bytes			raw bytes from randomBytes()
+ *		bits K			randomBits(K) values, stored little-endian in 1, 2
+ *						or 4 bytes depending on K
+ *		range MIN MAX	random(MIN, MAX) values, stored as little-endian
+ *						32-bit signed integers.  MAX - MIN is limited to
+ *						2^20, the RandomX1::random() limit
+ *
+ * The engine and pool layout are compile-time options of RandomX1, so they
+ * are chosen when building the tool:
+ *
+ *		g++ -O2 -std=gnu++14 -pthread -I../.. \
+ *			-DRANDOMX1_ENGINE=RandomX1Xorshift32 \
+ *			-DRANDOMX1_POOL_LAYOUT=RANDOMX1_POOL_STAGED \
+ *			-o randomx1_gen randomx1_gen.cpp
+ *
+ * Usage:
+ *		randomx1_gen [-s seed] [-t threads] [-n bytes] output mode [args]
+ *
+ */
+
+#include	<errno.h>
+#include	<fcntl.h>
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<sys/mman.h>
+#include	<unistd.h>
+
+#include	<atomic>
+#include	<chrono>
+#include	<functional>
+#include	<thread>
+#include	<vector>
+
+#include	"RandomX1.h"
+
+#define	STRINGIFY_(x)		#x
+#define	STRINGIFY(x)		STRINGIFY_(x)
+
+//
+// Bytes generated from one seed.  A multiple of every value width, so values
+// never straddle chunks.
+//
+static const size_t		CHUNK_BYTES = (size_t)1 << 20;
+
+// Largest -t
+static const unsigned	MAX_THREADS = 1024;
+
+
+enum Mode
+{
+	MODE_BYTES,
+	MODE_BITS,
+	MODE_RANGE
+};
+
+struct Options
+{
+	unsigned long	seed;
+	unsigned		threads;
+	size_t			size;
+	const char		*output;
+	Mode			mode;
+	uint8_t			bit_count;
+	long			min_val;
+	long			max_val;
+};
+
+//
+// seed_for_chunk()
+//
+// splitmix32 style mix, so chunks seeded from consecutive values don't
+// start at nearby positions of the engine sequence
+//
+static unsigned long seed_for_chunk(unsigned long seed, size_t index)
+{
+	uint32_t	z = (uint32_t)seed + (uint32_t)(index + 1) * 0x9e3779b9u;
+
+	z = (z ^ (z >> 16)) * 0x85ebca6bu;
+	z = (z ^ (z >> 13)) * 0xc2b2ae35u;
+	return z ^ (z >> 16);
+}
+
+//
+// element_size()
+//
+// Bytes per value written in 'mode'
+//
+static size_t element_size(const Options &opts)
+{
+	if(opts.mode == MODE_RANGE) {
+		return 4;
+	}
+	else if(opts.mode == MODE_BITS) {
+		return (opts.bit_count <= 8) ? 1 : ((opts.bit_count <= 16) ? 2 : 4);
+	}
+
+	return 1;
+}
+
+//
+// store_le()
+//
+static inline void store_le(uint8_t *out, uint32_t value, size_t bytes)
+{
+	for(size_t i = 0; i < bytes; i++) {
+		out[i] = (uint8_t)value;
+		value >>= 8;
+	}
+}
+
+//
+// fill_chunk()
+//
+// Fills 'length' bytes at 'out', chunk 'index' of the output
+//
+static void fill_chunk(const Options &opts, size_t index, uint8_t *out, size_t length)
+{
+	RandomX1	rng(seed_for_chunk(opts.seed, index));
+	size_t		width = element_size(opts);
+
+	switch(opts.mode) {
+	case MODE_BYTES:
+		rng.randomBytes(out, length);
+		break;
+
+	case MODE_BITS:
+		for(size_t i = 0; i < length; i += width) {
+			store_le(out + i, (uint32_t)rng.randomBits(opts.bit_count), width);
+		}
+		break;
+
+	case MODE_RANGE:
+		for(size_t i = 0; i < length; i += width) {
+			store_le(out + i, (uint32_t)rng.random(opts.min_val, opts.max_val), width);
+		}
+		break;
+	}
+}
+
+//
+// fill_chunks()
+//
+// Thread body, fills the next free chunk until there are none left
+//
+static void fill_chunks(const Options &opts, std::atomic<size_t> &next, uint8_t *map)
+{
+	size_t		chunk_count = (opts.size + CHUNK_BYTES - 1) / CHUNK_BYTES;
+	size_t		index, offset;
+
+	while((index = next++) < chunk_count) {
+		offset = index * CHUNK_BYTES;
+		fill_chunk(opts, index, map + offset,
+				(opts.size - offset < CHUNK_BYTES) ? (opts.size - offset) : CHUNK_BYTES);
+	}
+}
+
+//
+// usage()
+//
+static void usage(const char *name)
+{
+	fprintf(stderr,
+			"usage: %s [-s seed] [-t threads] [-n bytes] output mode [args]\n"
+			"\n"
+			"modes:\n"
+			"  bytes              raw random bytes\n"
+			"  bits K             randomBits(K), 1, 2 or 4 bytes per value\n"
+			"  range MIN MAX      random(MIN, MAX), 4 bytes per value,\n"
+			"                     MAX - MIN 2 to %ld\n"
+			"\n"
+			"-t is 1 to %u, default the number of CPUs\n"
+			"-n accepts K, M and G suffixes (powers of 1024), default 1G\n"
+			"The output is the same for any -t with the same seed\n",
+			name, RandomX1::MAX_VALUE_PER_RANDOM_REQUEST + 1, MAX_THREADS);
+}
+
+//
+// parse_size()
+//
+static bool parse_size(const char *text, size_t &size)
+{
+	char				*end;
+	unsigned long long	value;
+
+	errno = 0;
+	value = strtoull(text, &end, 10);
+
+	switch(*end) {
+	case 'G': case 'g':
+		value <<= 10;
+		// fall through
+	case 'M': case 'm':
+		value <<= 10;
+		// fall through
+	case 'K': case 'k':
+		value <<= 10;
+		end++;
+		break;
+	}
+
+	size = (size_t)value;
+	return (*end == '\0') && (end != text) && (errno == 0) && (strchr(text, '-') == NULL);
+}
+
+//
+// parse_long()
+//
+// strtol() that fails unless all of 'text' is a number that fits a long
+//
+static bool parse_long(const char *text, long &value, int base)
+{
+	char	*end;
+
+	errno = 0;
+	value = strtol(text, &end, base);
+
+	return (*end == '\0') && (end != text) && (errno == 0);
+}
+
+//
+// parse_unsigned()
+//
+// strtoul() that fails unless all of 'text' is a number that fits an
+// unsigned long.  strtoul() itself takes a leading '-' and negates.
+//
+static bool parse_unsigned(const char *text, unsigned long &value, int base)
+{
+	char	*end;
+
+	errno = 0;
+	value = strtoul(text, &end, base);
+
+	return (*end == '\0') && (end != text) && (errno == 0) && (strchr(text, '-') == NULL);
+}
+
+//
+// parse_options()
+//
+static bool parse_options(int argc, char **argv, Options &opts)
+{
+	int				opt;
+	long			bit_count;
+	unsigned long	threads;
+
+	opts.seed = 0;
+	opts.threads = std::thread::hardware_concurrency();
+	opts.size = (size_t)1 << 30;
+	opts.mode = MODE_BYTES;
+	opts.bit_count = 0;
+	opts.min_val = 0;
+	opts.max_val = 0;
+
+	while((opt = getopt(argc, argv, "s:t:n:h")) != -1) {
+		switch(opt) {
+		case 's':
+			if(!parse_unsigned(optarg, opts.seed, 0)) {
+				fprintf(stderr, "bad seed '%s'\n", optarg);
+				return false;
+			}
+			break;
+		case 't':
+			// Checked before narrowing to unsigned
+			if(!parse_unsigned(optarg, threads, 10) || threads < 1 || threads > MAX_THREADS) {
+				fprintf(stderr, "threads must be 1 to %u\n", MAX_THREADS);
+				return false;
+			}
+			opts.threads = (unsigned)threads;
+			break;
+		case 'n':
+			if(!parse_size(optarg, opts.size)) {
+				return false;
+			}
+			break;
+		default:
+			return false;
+		}
+	}
+
+	if(opts.threads == 0) {
+		opts.threads = 1;
+	}
+
+	if(argc - optind < 2) {
+		return false;
+	}
+
+	opts.output = argv[optind++];
+
+	if(strcmp(argv[optind], "bytes") == 0 && argc - optind == 1) {
+		opts.mode = MODE_BYTES;
+	}
+	else if(strcmp(argv[optind], "bits") == 0 && argc - optind == 2) {
+		opts.mode = MODE_BITS;
+
+		// Checked before narrowing, 257 must not wrap to 1
+		if(!parse_long(argv[optind + 1], bit_count, 10) || bit_count < 1 || bit_count > RandomX1::MAX_BITS_PER_RANDOM_REQUEST) {
+			fprintf(stderr, "bits must be 1 to %u\n", RandomX1::MAX_BITS_PER_RANDOM_REQUEST);
+			return false;
+		}
+
+		opts.bit_count = (uint8_t)bit_count;
+	}
+	else if(strcmp(argv[optind], "range") == 0 && argc - optind == 3) {
+		opts.mode = MODE_RANGE;
+
+		if(!parse_long(argv[optind + 1], opts.min_val, 0) || !parse_long(argv[optind + 2], opts.max_val, 0)) {
+			fprintf(stderr, "bad range '%s' '%s'\n", argv[optind + 1], argv[optind + 2]);
+			return false;
+		}
+
+		// random() returns MIN for every value of an empty or one value
+		// range
+		if((long long)opts.max_val - opts.min_val < 2) {
+			fprintf(stderr, "MAX must be at least MIN + 2\n");
+			return false;
+		}
+
+		// random() would silently clamp a wider range
+		if((long long)opts.max_val - opts.min_val > RandomX1::MAX_VALUE_PER_RANDOM_REQUEST + 1) {
+			fprintf(stderr, "MAX - MIN must be at most %ld\n", RandomX1::MAX_VALUE_PER_RANDOM_REQUEST + 1);
+			return false;
+		}
+	}
+	else {
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	Options						opts;
+	std::vector<std::thread>	threads;
+	std::atomic<size_t>			next(0);
+	uint8_t						*map;
+	size_t						width;
+	double						seconds;
+	int							fd;
+
+	if(!parse_options(argc, argv, opts)) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	// Whole values only
+	width = element_size(opts);
+	opts.size -= opts.size % width;
+
+	if(opts.size == 0) {
+		fprintf(stderr, "%s: nothing to write\n", argv[0]);
+		return 2;
+	}
+
+	if((fd = open(opts.output, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0) {
+		fprintf(stderr, "%s: %s: %s\n", argv[0], opts.output, strerror(errno));
+		return 1;
+	}
+
+	if(ftruncate(fd, (off_t)opts.size) != 0) {
+		fprintf(stderr, "%s: %s: %s\n", argv[0], opts.output, strerror(errno));
+		close(fd);
+		return 1;
+	}
+
+	map = (uint8_t *)mmap(NULL, opts.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	if(map == MAP_FAILED) {
+		fprintf(stderr, "%s: mmap: %s\n", argv[0], strerror(errno));
+		close(fd);
+		return 1;
+	}
+
+	std::chrono::steady_clock::time_point	start = std::chrono::steady_clock::now();
+
+	for(unsigned i = 0; i < opts.threads; i++) {
+		threads.push_back(std::thread(fill_chunks, std::cref(opts), std::ref(next), map));
+	}
+
+	for(size_t i = 0; i < threads.size(); i++) {
+		threads[i].join();
+	}
+
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	if(munmap(map, opts.size) != 0 || close(fd) != 0) {
+		fprintf(stderr, "%s: %s: %s\n", argv[0], opts.output, strerror(errno));
+		return 1;
+	}
+
+	fprintf(stderr, "%s: %zu bytes, engine %s, layout %d, %u threads, %.3f s, %.2f GB/s\n",
+			opts.output, opts.size, STRINGIFY(RANDOMX1_ENGINE), RANDOMX1_POOL_LAYOUT,
+			opts.threads, seconds, opts.size / seconds / 1e9);
+	return 0;
+}